@@ -48,15 +48,34 @@
 #include <ctype.h>
 #include <stdarg.h>
 #include <assert.h>
+#include <time.h>
+#include <setjmp.h>
+#include <sys/stat.h>
+#if defined(__unix__) || defined(__APPLE__)
+#define HAVE_FORK	//-j splits --batch jobs between processes
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+#ifdef _WIN32
+__declspec(dllimport) void __stdcall Sleep(unsigned long);
+#endif
+#include "asm6f.h"
 
 #define VERSION "1.7"
 
 #define addr firstlabel.value	// '$' value
 #define NOORIGIN -0x40000000	// nice even number so aligning works before origin is defined
-#define INITLISTSIZE 128		// initial label list size
+#define INITLISTSIZE 1024		// initial label/name table size (power of 2)
 #define BUFFSIZE 8192			// file buffer (inputbuff, outputbuff) size
 #define STACKBUFFSIZE 512       // stack-allocated buffer size.
-#define IPS_RLE_EXTRACT 0x20    // if this many bytes in a row is encountered, use RLE encoding.
+#define IPS_RLE_EXTRACT 0x20    // fills at least this long are kept as RLE hunks while assembling.
+#define IPS_EOF 0x454f46        // a record at this offset would read as the "EOF" marker
+#define IPS_MAXSIZE 0x1000000   // IPS offsets are 24 bits
 #define HEADERSIZE 0x10 		// size of an ines/nes2 header
 #define WORDMAX 128				// used with getword()
 #define LINEMAX 2048			// plenty of room for nested equates
@@ -85,9 +104,8 @@ typedef struct {
 	// (only meaningful for labels corresponding to an address.)
 	int pos;				
 
-	char *line;			//for macro or equate, also used to mark unknown label
-							//*next:text->*next:text->..
-							//for macros, the first <value> lines hold param names
+	char *line;			//for equate, also used to mark unknown label
+							//for macros, this points to a macrodef (see below)
 							//for opcodes (reserved), this holds opcode definitions, see initlabels
 	int type;				//labeltypes enum (see above)
 	int used;				//for EQU and MACRO recursion check
@@ -118,9 +136,94 @@ typedef struct {
 	int pos;
 } comment;
 
+//every label name is interned once; labels with the same name share the string
+typedef struct {
+	char *name;			//NULL for an empty slot
+	unsigned hash;
+	label *newest;			//label most recently created with this name (for exports)
+} labelname;
+
+//all labels with the same name and scope, newest first, chained through link
+//(only '+' labels ever have more than one label in a chain)
+typedef struct {
+	const char *name;		//interned name, NULL for an empty slot
+	int scope;
+	unsigned hash;
+	label *chain;
+} labelslot;
+
+//a symbol found in a source line by lexline(). only reserved words are resolved;
+//other symbols are just located, and looked up again by eval() every pass
+typedef struct {
+	short start;			//offset of symbol in line
+	short len;
+	short ifdef;			//symbol is IFDEF or IFNDEF (see expandline)
+	short slot;				//in a macro body: param number+1, or -1 if not a param (0=unknown)
+	label *rsvd;			//reserved word this symbol names, if any
+} token;
+
+//a source line, lexed on first use. later passes rebuild the expanded text from the
+//tokens instead of rescanning it, then parse and evaluate that text as before
+typedef struct {
+	char *text;
+	token *toks;			//symbols in text, in order
+	short ntoks;
+	short comment;			//offset of ';' in text, or -1
+	int lexed;				//0=not yet, 1=toks are valid, -1=never lex this line
+	struct linememo_t *memo;	//result from an earlier pass, if the line can be replayed
+} srcline;
+
+//a macro definition. the body is compiled into lexed lines the first time the macro
+//is used, with every use of a param marked as a slot that expandmacro() fills in.
+typedef struct {
+	char *text;				//*next:text->*next:text->.. as stored by processline
+							//(the first <value> lines hold param names)
+	char **params;			//param names (compiled)
+	int paramcount;
+	srcline *lines;			//body (compiled)
+	int linecount;
+	int needlabels;			//bind args as local EQU labels instead of filling slots
+} macrodef;
+
+#define MAXMACROARGS 32		// macros with more params than this bind their args as labels
+
+//args of the macro being expanded
+typedef struct {
+	macrodef *def;
+	int scope;				//args are only visible in this scope, like the local labels they stand for
+	char *arg[MAXMACROARGS];	//arg text, NULL if no arg was given
+	char used[MAXMACROARGS];	//for recursion check
+} macroframe;
+
 typedef unsigned char byte;
 typedef void (*icfn)(label*,char**);
 
+//a symbol lookup made while assembling a memoized line, and what it found
+typedef struct {
+	label *p;				//NULL if nothing was found
+	ptrdiff_t value;
+	char *line;				//(known/unknown label, equate text)
+	int type;
+	int current;			//(*p).pass==pass
+	int name;				//offset of the name in the memo's text
+} memodep;
+
+//a line that only assembled an instruction or data remembers its bytes and every
+//symbol lookup it made. later passes output the bytes again without re-parsing
+//the line, as long as every lookup still finds the same thing.
+typedef struct linememo_t {
+	int size;				//bytes allocated for the memo
+	int valid;
+	int pc;					//address the line was assembled at, or -1 if it didn't matter
+	int flags;				//memoflags() at the time
+	int cdlflag;
+	int ndeps,nbytes;
+	int listtext;			//offset of the expanded line in text, or -1
+	memodep *deps;
+	byte *bytes;
+	char *text;				//dep names, then the expanded line
+} linememo;
+
 //unstable instruction allowance
 int allowunstable = 0;
 int allowhunstable = 0;
@@ -206,8 +309,16 @@ void hunstable(label*,char**);
 
 // forward declarations
 label *findlabel(char*);
+void pch_dep(char*,label*);
+void pch_line(label*);
+void cache_input(char*,int,unsigned long long);
+FILE *openoutput(const char*,const char*);
 void initlabels();
-label *newlabel();
+label *newlabel(int);
+labelname *internname(void);
+void addlabelchain(labelname*,label*);
+label **sortedlabels(int (*)(const void*,const void*));
+int comparelabelnames(const void*,const void*);
 void getword(char*,char**,int);
 int getvalue(char**);
 int getoperator(char**);
@@ -215,11 +326,30 @@ int eval(char**,int);
 label *getreserved(char**);
 int getlabel(char*,char**);
 void processline(char*,char*,int);
+void processsrcline(srcline*,char*,int);
 void listline(char*,char*);
 void endlist();
 void flush_output(int);
+void write_cdl();
+void write_deltapatches();
+void dbg_reset();
+void dbg_addbytes(int);
+void export_dbg();
+enum profkinds {PROF_LINE,PROF_MACRO,PROF_REPT,PROF_INCLUDE,PROF_INCBIN,PROF_PASS};
+double prof_now(void);
+void prof_reset(void);
+void prof_end(int,const char*,int,double,int);
+void export_profile();
+void output(byte*,int,int);
+void memo_dep(char*,label*);
+void memo_bytes(byte*,int,int);
+enum passnotekinds {NOTE_MOVED,NOTE_UNRESOLVED,NOTE_BRANCH,NOTE_COUNT};
+extern int passnotecount;
+void passnote(int,const char*,int,int);
+void pass_report(double);
 char* find_ext(char*);
 char* replace_ext(char*, char*);
+char* insert_ext(char*, char*);
 
 // [freem addition (from asm6_sonder.c)]
 int filepos=0;
@@ -231,28 +361,28 @@ int filesize=0;
 // if output buffer is empty, this should agree with filepos.
 int ips_outpos=0;
 
-typedef struct ips_hunk_t {
+typedef struct {
 	int offset;
 	int length;
 	byte* contents; // if nullptr, rle.
 	byte rle_content;
 	int suppress; // if true, don't write to ips output.
-	struct ips_hunk_t* next;
 } ips_hunk;
 
-// linked list of IPS hunks
-ips_hunk* ips_hunk_head = 0;
-ips_hunk* ips_hunk_tail = 0;
+// IPS hunks, sorted by offset and never overlapping.
+// a hunk written over older ones trims or splits them.
+ips_hunk* ips_hunks = 0;
+int ips_hunkcount = 0;
+int ips_hunkmax = 0; // # of hunks ips_hunks has room for
 
-void ips_append_hunk();
-// writes patch to output file
+void ips_add_hunk(ips_hunk*);
 void ips_write(FILE* file);
 
 enum optypes {ACC,IMM,IND,INDX,INDY,ZPX,ZPY,ABSX,ABSY,ZP,ABS,REL,IMP};
 int opsize[]={0,1,2,1,1,1,1,2,2,1,2,1,0};
 char ophead[]={0,'#','(','(','(',0,0,0,0,0,0,0,0};
 char *optail[]={"A","",")",",X)","),Y",",X",",Y",",X",",Y","","","",""};
-byte brk[]={0x00,IMM,0x00,ZP,0x00,IMP,-1};
+byte op_brk[]={0x00,IMM,0x00,ZP,0x00,IMP,-1};
 byte ora[]={0x09,IMM,0x01,INDX,0x11,INDY,0x15,ZPX,0x1d,ABSX,0x19,ABSY,0x05,ZP,0x0d,ABS,-1};
 byte asl[]={0x0a,ACC,0x16,ZPX,0x1e,ABSX,0x06,ZP,0x0e,ABS,0x0a,IMP,-1};
 byte php[]={0x08,IMP,-1};
@@ -340,7 +470,7 @@ byte xaa[]={0x8b,IMM,-1};
 //byte lax[]={0xab,IMM,-1};
  
 void *rsvdlist[]={	   //all reserved words
-		"BRK",brk,
+		"BRK",op_brk,
 		"PHP",php,
 		"BPL",bpl,
 		"CLC",clc,
@@ -504,7 +634,8 @@ char NeedName[]="Need a name.";
 char CantCreateFile[]="Can't create output file.";
 char CantOpen[]="Can't open file.";
 char CantWrite[]="Write error.";
-char CompFailed[]="Compare failed. Byte at 0x________ was 0x++.";
+char CompFailed[]="Compare failed. Byte at 0x%06x was 0x%x.";
+char compfailmsg[sizeof(CompFailed)+16];//CompFailed, filled in
 char CantSeek[]="Can't seek in file.";
 char CantSeekEnum[]="Can't seek in enum mode.";
 char InvalidHeader[]="iNES header invalid.";
@@ -514,6 +645,7 @@ char ExtraENDE[]="ENDE without ENUM.";
 char ExtraENDINL[]="ENDINL without IGNORENL.";
 char RecurseMACRO[]="Recursive MACRO not allowed.";
 char RecurseEQU[]="Recursive EQU not allowed.";
+char RecurseINCLUDE[]="Recursive INCLUDE not allowed.";
 char NoENDIF[]="Missing ENDIF.";
 char NoENDM[]="Missing ENDM.";
 char NoENDR[]="Missing ENDR.";
@@ -521,6 +653,8 @@ char NoENDE[]="Missing ENDE.";
 char NoENDINL[]="Missing ENDINL.";
 char IfNestLimit[]="Too many nested IFs.";
 char undefinedPC[]="PC is undefined (use ORG first)";
+char IPSOutOfRange[]="IPS patches can't reach past 16MB.";
+char NoBaseROM[]="BPS/UPS patches need a base ROM (use INCNES).";
 
 char whitesp[]=" \t\r\n:";  //treat ":" like whitespace (for labels)
 char whitesp2[]=" \t\r\n\"";	//(used for filename processing)
@@ -544,27 +678,64 @@ char *outputfilename=0;
 char *ipsfilename=0;
 char *listfilename=0;
 char *cdlfilename=0;
+char *bpsfilename=0;
+char *upsfilename=0;
+char *baseromname=0;//file the first INCNES read (base rom for -b/-u)
 int verboselisting=0;//expand REPT loops in listing
 int genfceuxnl=0;//[freem addition] generate FCEUX .nl files for symbolic debugging
 int genmesenlabels=0; //generate label files for use with Mesen
+int gendbg=0; //generate debug database (1=binary .dbg, 2=JSON .dbg.json)
+int profiling=0; //time the assembler itself (--profile)
+int profbytes=0; //bytes output so far (for --profile)
+int passreport=0; //explain what made each pass necessary (--pass-report)
+int memorec=0; //recording a line memo (memo_dep, memo_bytes)
+int memook=0; //the line being recorded can still be memoized
+int memoaddr=0; //the line being recorded used the PC
+int memohits=0; //lines replayed from their memo this pass
+struct pchfile_t *pchrec=0; //file whose --pch snapshot is being recorded (pch_dep, pch_line)
+int cacherec=0; //noting the files read and written for --cache (cache_input, openoutput)
 int gencdl=0; //generate CDL file
 int genlua=0;//generate lua symbol file
 int genips=0; //[NaOH] generate .ips patch.
+int genbps=0; //generate .bps patch against the INCNES rom
+int genups=0; //generate .ups patch against the INCNES rom
+int showmemstats=0; //print arena usage when done (--mem-stats)
 const char *listerr=0;//error message for list file
+char *dbgsrc=0;//source (or macro/REPT expansion chain) of the line being processed
+int dbgline=0;//its line number
+char *dbgfile=0;//file and line that started the current expansion
+int dbgfileline=0;
+int dbgseq=0;//number of the line being processed, output from the same line is merged
+int dbglines=0;//lines processed so far
 label *labelhere;//points to the label being defined on the current line (for EQU, =, etc)
-FILE *listfile=0;
-FILE *outputfile=0;
-FILE *cdlfile=0;
+byte *romimage=0;//output file contents, written to disk once assembly is done
+int romimagesize=0;//bytes allocated for romimage (filesize is how many are used)
+int outputstarted=0;//something has been output (or seeked)
+int outputpass=0;//pass the output was last started for (note that the first pass is pass=1)
+int listpass=0;//pass the listing was last started for
+int includenest=0;//INCLUDEs being processed (0=none, 1=main source file)
+int watching=0;//rebuild whenever a source file changes (--watch)
+char *batchfilename=0;//manifest of jobs to assemble (--batch)
+int batchjobs=1;//processes to split the --batch jobs between (-j)
+#define MAXCONFIGS 64
+char *configs[MAXCONFIGS];//configurations to build (--config name[=symbols])
+int configcount=0;
+byte *cdlimage=0;//CDL flags for each byte of romimage (only with -c)
+int cdlimagesize=0;//bytes allocated for cdlimage
 byte outputbuff[BUFFSIZE];
 byte inputbuff[BUFFSIZE];
 byte ines_extension[HEADERSIZE];
 byte ines_extension_mask[HEADERSIZE] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 int outcount;//bytes waiting in outputbuff
-label **labellist;  //array of label pointers (list starts from center and grows outward)
-int labels;//# of labels in labellist
-int maxlabels;//max # of labels labellist can hold
-int labelstart;//index of first label
-int labelend;//index of last label
+labelname *labelnames;//interned label names (hash table, open addressing)
+int labels;//# of names in labelnames
+int maxlabels;//# of slots in labelnames (power of 2, kept at most half full)
+labelslot *labellist;//label chains keyed on (interned name, scope) (hash table, open addressing)
+int labelchains;//# of chains in labellist
+int maxlabelchains;//# of slots in labellist (power of 2, kept at most half full)
+labelname *findname;//name entry from last findlabel, NULL if name was never seen (used by newlabel)
+char *findstr;//.
+unsigned findhash;//.
 label *lastlabel;//last label created
 comment **comments;
 int commentcount;
@@ -575,6 +746,7 @@ int nonl=0;//[freem addition] supress output to .nl files
 int defaultfiller;//default fill value
 int comparefiller=0; // compare on write to defaultfiller
 int insidemacro=0;//macro/rept is being expanded
+macroframe *curframe=0;//args of the innermost macro being expanded (NULL if it binds labels)
 int verbose=1;
 
 static void* ptr_from_bool( int b )
@@ -585,23 +757,67 @@ static void* ptr_from_bool( int b )
 	return NULL;
 }
 
+// where fatal_error() goes instead of exiting (set while --watch or the library is building)
+jmp_buf *fataljump = 0;
+
+// error messages are collected here instead of going to stderr when
+// assembling through the library (asm6f_assemble)
+int diagcapture = 0;
+char *diagbuf = 0;
+size_t diaglen = 0;
+size_t diagmax = 0;
+
+static void vdiagnostic( const char fmt [], va_list args )
+{
+	va_list copy;
+	int n;
+	
+	if ( !diagcapture ) {
+		vfprintf( stderr, fmt, args );
+		return;
+	}
+	va_copy( copy, args );
+	n = vsnprintf( 0, 0, fmt, copy );
+	va_end( copy );
+	if ( n < 0 )
+		return;
+	if ( diaglen + n + 1 > diagmax ) {
+		diagmax = ( diaglen + n + 1 ) * 2;
+		diagbuf = (char*)realloc( diagbuf, diagmax );
+		if ( !diagbuf )
+			exit( EXIT_FAILURE );
+	}
+	vsnprintf( diagbuf + diaglen, n + 1, fmt, args );
+	diaglen += n;
+}
+
+// Prints printf-style error message to stderr (or keeps it for the library).
+static void diagnostic( const char fmt [], ... )
+{
+	va_list args;
+	va_start( args, fmt );
+	vdiagnostic( fmt, args );
+	va_end( args );
+}
+
 // Prints printf-style message to stderr, then exits.
-// Closes and deletes output file.
+// Deletes output file, since it would be stale.
 static void fatal_error( const char fmt [], ... )
 {
 	va_list args;
 	
-	if ( outputfile != NULL ) {
-		fclose( outputfile );
+	if ( outputstarted && outputfilename ) {
 		remove( outputfilename );
 	}
 	
 	va_start( args, fmt );
-	fprintf( stderr, "\nError: " );
-	vfprintf( stderr, fmt, args );
-	fprintf( stderr, "\n\n" );
+	diagnostic( "\nError: " );
+	vdiagnostic( fmt, args );
+	diagnostic( "\n\n" );
 	va_end( args );
 	
+	if ( fataljump )
+		longjmp( *fataljump, 1 );
 	exit( EXIT_FAILURE );
 }
 
@@ -626,15 +842,145 @@ static char* my_malloc( size_t s )
 	return p;
 }
 
-// Same as common strdup(), but prints error and exits if allocation fails
-static char* my_strdup(const char *in)
+//-------------------------------------------------------
+//arena allocator
+//-------------------------------------------------------
+
+// Small objects that live until the end of a pass or of the whole assembly
+// are carved out of large blocks and released all at once, instead of
+// going through malloc/free one by one.
+
+#define ARENABLOCK 0x10000		// default arena block size
+#define ARENAALIGN 16			// alignment of every arena allocation
+
+typedef struct arenablock_t {
+	struct arenablock_t *next;	//older block
+	size_t size;			//usable bytes
+	size_t used;
+} arenablock;
+
+#define ARENAHEADER ((sizeof(arenablock)+ARENAALIGN-1)&~(size_t)(ARENAALIGN-1))
+
+typedef struct {
+	arenablock *head;		//block being filled, older blocks chained behind it
+	arenablock *spare;		//released blocks kept for reuse
+} arena;
+
+typedef struct {
+	arenablock *block;
+	size_t used;
+} arenamark;
+
+//what the memory is used for (--mem-stats)
+enum memcategories {MEM_LABELS,MEM_NAMES,MEM_EQUATES,MEM_MACROS,MEM_REPT,MEM_COMMENTS,MEM_IPS,MEM_SOURCE,MEM_LISTING,MEM_DEBUG,MEM_MEMO,MEM_COUNT};
+const char *memcategorynames[MEM_COUNT]={"labels","names","equates","macros","rept","comments","ips","source","listing","debug","line memos"};
+
+struct {
+	size_t bytes;
+	int count;
+} memstats[MEM_COUNT];
+int memblocks=0;			//arena blocks malloc'd
+size_t memreserved=0;		//total size of those blocks
+
+arena asmarena;		//lives as long as the assembly (labels, names, macros, source cache)
+arena passarena;	//reset at the start of every pass (comments, IPS hunks)
+arena reptarena;	//REPT bodies, released back to a mark after each expansion
+
+static void *arena_alloc( arena *a, size_t size, int category )
+{
+	arenablock *b;
+	char *p;
+
+	size = ( size + ARENAALIGN - 1 ) & ~(size_t)( ARENAALIGN - 1 );
+	memstats[category].bytes += size;
+	memstats[category].count++;
+
+	b = a->head;
+	if ( !b || b->used + size > b->size ) {
+		b = a->spare;
+		if ( b && b->size >= size ) {
+			a->spare = b->next;
+		} else {
+			size_t blocksize = size > ARENABLOCK ? size : ARENABLOCK;
+			b = (arenablock*)my_malloc( ARENAHEADER + blocksize );
+			b->size = blocksize;
+			memblocks++;
+			memreserved += ARENAHEADER + blocksize;
+		}
+		b->used = 0;
+		b->next = a->head;
+		a->head = b;
+	}
+	p = (char*)b + ARENAHEADER + b->used;
+	b->used += size;
+	return p;
+}
+
+static char *arena_strdup( arena *a, const char *in, int category )
 {
 	size_t size = strlen( in ) + 1;
-	char* out = my_malloc( size );
-		memcpy( out, in, size );
+	char *out = (char*)arena_alloc( a, size, category );
+	memcpy( out, in, size );
 	return out;
 }
 
+static arenamark arena_mark( arena *a )
+{
+	arenamark m;
+	m.block = a->head;
+	m.used = a->head ? a->head->used : 0;
+	return m;
+}
+
+// Releases everything allocated after mark m. Blocks are kept for reuse.
+static void arena_release( arena *a, arenamark m )
+{
+	while ( a->head != m.block ) {
+		arenablock *b = a->head;
+		a->head = b->next;
+		b->next = a->spare;
+		a->spare = b;
+	}
+	if ( a->head )
+		a->head->used = m.used;
+}
+
+static void arena_reset( arena *a )
+{
+	arenamark m = { 0, 0 };
+	arena_release( a, m );
+}
+
+// Gives all of the arena's memory back to the system.
+static void arena_free( arena *a )
+{
+	arenablock *b;
+
+	arena_reset( a );
+	while ( ( b = a->spare ) ) {
+		a->spare = b->next;
+		free( b );
+	}
+}
+
+#ifndef ASM6F_NO_MAIN
+static void show_memstats( void )
+{
+	size_t total = 0;
+	int i, count = 0;
+
+	printf( "memory usage:\n" );
+	for ( i = 0; i < MEM_COUNT; i++ ) {
+		printf( "  %-10s %10lu bytes in %8i allocations\n", memcategorynames[i],
+			(unsigned long)memstats[i].bytes, memstats[i].count );
+		total += memstats[i].bytes;
+		count += memstats[i].count;
+	}
+	printf( "  %-10s %10lu bytes in %8i allocations\n", "total", (unsigned long)total, count );
+	printf( "  %i arena blocks, %lu bytes reserved\n", memblocks, (unsigned long)memreserved );
+}
+#endif
+
 //-------------------------------------------------------
 //parsing functions
 //-------------------------------------------------------
@@ -712,6 +1058,7 @@ int getvalue(char **str) {
 		s++;
 		if(!*s) {
 			ret=addr;//$ by itself is the PC			
+			memoaddr=1;
 		} else do {
 hexi:	   j=hexify(*s);
 			s++;
@@ -767,9 +1114,13 @@ bin:		j=*s;
 			if(lastchance) {//only show error once we're certain label will never exist
 				errmsg=UnknownLabel;
 			}
+			if(passreport)
+				passnote(NOTE_UNRESOLVED,gvline,0,0);
 		} else {
 			dependant|=!(*p).line;
 			needanotherpass|=!(*p).line;
+			if(passreport && !(*p).line)
+				passnote(NOTE_UNRESOLVED,gvline,0,0);
 			if((*p).type==LABEL || (*p).type==VALUE) {
 				ret=(*p).value;
 			} else if((*p).type==MACRO) {
@@ -857,7 +1208,7 @@ int eval(char **str,int precedence) {
 	char unary;
 	char *s,*s2;
 	int ret,val2;
-	int op;
+	int op,notes;
 	
 	s=*str+strspn(*str,whitesp);		//eatwhitespace
 	unary=*s;
@@ -898,6 +1249,7 @@ int eval(char **str,int precedence) {
 			s++;
 			op=dependant;//eval() is reentrant so don't mess up dependant
 			val2=needanotherpass;
+			notes=passnotecount;
 			dependant=0;
 			ret=getvalue(&s2);
 			if (errmsg == UnknownLabel)
@@ -909,6 +1261,7 @@ int eval(char **str,int precedence) {
 			} else {//not a label after all..
 				dependant=op;
 				needanotherpass=val2;
+				passnotecount=notes;
 			}
 			if(s2) {//if it wasn't a +-label
 				ret=eval(&s,UNARY);
@@ -1021,11 +1374,50 @@ void getfilename(char *dst, char **next) {
 	}
 }
 
+//reserved words already looked up by lexline(), by position in the expanded line
+#define MAXHINTS 8
+typedef struct {
+	char *base;				//expanded line these offsets refer to
+	int count;
+	struct {
+		short start,len;
+		label *rsvd;
+	} hint[MAXHINTS];
+} rsvdhints;
+
+rsvdhints *curhints=0;//hints for the line being processed (NULL if none)
+int rsvdshadowed=0;//set once any reserved word gets shadowed by a local label
+
+//if lexline() already found the reserved word starting at src, return it
+label *gethint(char *src,int *len) {
+	int i,off;
+	label *p;
+	char c;
+
+	if(!curhints || rsvdshadowed)
+		return 0;
+	off=(int)(src-curhints->base);
+	if(off<0 || off>=LINEMAX)
+		return 0;
+	for(i=0;i<curhints->count;i++) {
+		if(curhints->hint[i].start!=off)
+			continue;
+		p=curhints->hint[i].rsvd;
+		*len=curhints->hint[i].len;
+		c=src[*len];//getword() must stop at the same place
+		if((*p).type!=RESERVED || (c && !strchr(whitesp,c) && !strchr(mathy,c)))
+			return 0;
+		return p;
+	}
+	return 0;
+}
+
 //get word in src, advance src, and return reserved label*
 label *getreserved(char **src) {
 	char dst[WORDMAX];
 	char upp[WORDMAX];
 	label *p;
+	int len;
 	
 	*src+=strspn(*src,whitesp);//eatwhitespace
 	if(**src=='=') {//special '=' reserved word
@@ -1033,6 +1425,11 @@ label *getreserved(char **src) {
 		upp[1]=0;
 		(*src)++;
 	} else {
+		if((p=gethint(*src,&len))) {//already looked up by lexline()
+			*src+=len;
+			if(**src==':') (*src)++;
+			return p;
+		}
 		if(**src=='.')//reserved words can start with "."
 			(*src)++;
 		getword(dst,src,1);
@@ -1079,6 +1476,38 @@ int getlabel(char *dst,char **src) {
 	}
 }
 
+char *expandline(char*,char*);
+
+//index of the param called name in macro md, or -1
+int findparam(macrodef *md,const char *name) {
+	int i;
+	for(i=0;i<md->paramcount;i++)
+		if(!strcmp(md->params[i],name))
+			return i;
+	return -1;
+}
+
+//if name is a bound arg of the macro being expanded, expand it into dst and return 1.
+//slot is the token's param slot (see token), 0 if unknown.
+int expandparam(char *dst,char *name,int slot) {
+	macroframe *f=curframe;
+	if(!f || f->scope!=scope || slot<0)
+		return 0;
+	slot=slot ? slot-1 : findparam(f->def,name);
+	if(slot<0 || !f->arg[slot])
+		return 0;
+	if(f->used[slot]) {
+		errmsg=RecurseEQU;
+		if(dst!=name)
+			strcpy(dst,name);
+	} else {
+		f->used[slot]=1;
+		expandline(dst,f->arg[slot]);
+		f->used[slot]=0;
+	}
+	return 1;
+}
+
 //Expand all equates from src into dst, and remove comment
 //returns a pointer to the comment in src or null.
 //CRIPES what a mess...
@@ -1143,6 +1572,10 @@ char *expandline(char *dst,char *src) {
 				my_strupr(upp);
 				if(!strcmp(upp,"IFDEF") || !strcmp(upp,"IFNDEF")) {
 					def_skip=1;
+				} else if(expandparam(dst,start,0)) {
+					dst+=strlen(dst);
+					*src=c;
+					continue;
 				} else {
 					p=findlabel(start);
 				}
@@ -1180,6 +1613,141 @@ char *expandline(char *dst,char *src) {
 	return comment;
 }
 
+//find the symbols and comment in sl, scanning the same way expandline() does,
+//so later passes can expand the line without rescanning it.
+//symbols naming a reserved word get it as a hint for getreserved(). labels are not
+//resolved to handles: what a name means depends on the pass, the scope and the
+//equates seen so far, and the label tables move when they grow.
+//the tokens are allocated from arena a.
+void lexline(srcline *sl,arena *a,int category) {
+	token toks[LINEMAX/2];
+	char upp[WORDMAX];
+	char *text=sl->text;
+	char *src=text;
+	char *start;
+	char c,c2;
+	label *p;
+	int n=0,len;
+
+	sl->comment=-1;
+	for(;;) {
+		c=*src;
+		if(!c)
+			break;
+		if(c=='$' || (c>='0' && c<='9')) {//numbers
+			do {
+				src++;
+				c=*src;
+			} while((c>='0' && c<='9') || (c>='A' && c<='H') || (c>='a' && c<='h'));
+		} else if(c=='"' || c=='\'') {//quotes
+			src++;
+			do {
+				c2=*src;
+				if(c2=='\\' && src[1])
+					src++;
+				if(c2)
+					src++;
+			} while(c2 && c2!=c);
+			if(!c2)
+				break;
+		} else if(c=='_' || c=='.' || c==LOCALCHAR || (c>='A' && c<='Z') || (c>='a' && c<='z')) {//symbol
+			start=src;
+			do {
+				src++;
+				c=*src;
+			} while(c=='_' || c=='.' || c==LOCALCHAR || (c>='0' && c<='9') || (c>='A' && c<='Z') || (c>='a' && c<='z'));
+			len=(int)(src-start);
+			toks[n].start=(short)(start-text);
+			toks[n].len=(short)len;
+			toks[n].ifdef=0;
+			toks[n].slot=0;
+			toks[n].rsvd=0;
+			if(len<WORDMAX-1) {
+				memcpy(upp,start+(*start=='.'),len-(*start=='.'));
+				upp[len-(*start=='.')]=0;
+				my_strupr(upp);
+				toks[n].ifdef=!strcmp(upp,"IFDEF") || !strcmp(upp,"IFNDEF");
+				if(!rsvdshadowed && (p=findlabel(upp)) && (*p).type==RESERVED)
+					toks[n].rsvd=p;
+			}
+			n++;
+		} else if(c==';') {//comment
+			sl->comment=(short)(src-text);
+			break;
+		} else {
+			src++;
+		}
+	}
+	sl->ntoks=n;
+	sl->toks=0;
+	sl->memo=0;
+	if(n) {
+		sl->toks=(token*)arena_alloc(a,n*sizeof(token),category);
+		memcpy(sl->toks,toks,n*sizeof(token));
+	}
+	sl->lexed=1;
+}
+
+//same as expandline(), but using the tokens found by lexline().
+//reserved words that are copied unchanged are recorded in hints for getreserved().
+char *expandlexed(char *dst,srcline *sl,rsvdhints *hints) {
+	char *src=sl->text;
+	char *line=dst;
+	token *t;
+	label *p;
+	int i,pos=0,def_skip=0,end;
+
+	hints->base=line;
+	hints->count=0;
+	for(i=0;i<sl->ntoks;i++) {
+		t=&sl->toks[i];
+		memcpy(dst,src+pos,t->start-pos);
+		dst+=t->start-pos;
+		memcpy(dst,src+t->start,t->len);
+		dst[t->len]=0;
+		pos=t->start+t->len;
+
+		p=0;
+		if(!def_skip) {
+			if(t->ifdef)
+				def_skip=1;
+			else if(expandparam(dst,dst,t->slot)) {
+				dst+=strlen(dst);
+				continue;
+			} else
+				p=findlabel(dst);
+		}
+		if(p) {
+			if((*p).type!=EQUATE || (*p).pass!=pass)
+				p=0;
+			else {
+				if((*p).used) {
+					p=0;
+					errmsg=RecurseEQU;
+				}
+			}
+		}
+		if(p) {
+			(*p).used=1;
+			expandline(dst,(*p).line);
+			(*p).used=0;
+			dst+=strlen(dst);
+		} else {
+			if(t->rsvd && hints->count<MAXHINTS) {
+				hints->hint[hints->count].start=(short)(dst-line);
+				hints->hint[hints->count].len=t->len;
+				hints->hint[hints->count].rsvd=t->rsvd;
+				hints->count++;
+			}
+			dst+=t->len;
+		}
+	}
+	end=sl->comment>=0 ? sl->comment : (int)strlen(src);
+	memcpy(dst,src+pos,end-pos);
+	dst[end-pos]=0;
+	return sl->comment>=0 ? src+sl->comment : 0;
+}
+
 int eatchar(char **str,char c) {
 	if(c) {
 		*str+=strspn(*str,whitesp);	 //eatwhitespace
@@ -1209,6 +1777,7 @@ void export_labelfiles() {
 	int i;
 	int bank;
 	label *l;
+	label **list;
 	char str[512];
 	char filename[512];
 	char* strptr;
@@ -1223,7 +1792,7 @@ void export_labelfiles() {
 	strcpy(filename, outputfilename);
 	strptr = find_ext(filename);
 	sprintf(strptr, ".nes.ram.nl");
-	ramfile= fopen(filename, "w");
+	ramfile= openoutput(filename, "w");
 
 	// the bank files are created ad-hoc before being written to.
 
@@ -1234,8 +1803,9 @@ void export_labelfiles() {
 
 	// todo: include EQUATES for other registers and variables
 
-	for(i=labelstart;i<=labelend;i++){
-		l=labellist[i];
+	list=sortedlabels(comparelabelnames);
+	for(i=0;i<labels;i++){
+		l=list[i];
 
 		// [freem addition]: handle IGNORENL'd labels
 		if((*l).ignorenl)
@@ -1261,7 +1831,7 @@ void export_labelfiles() {
 				bank=(((*l).pos - HEADERSIZE)/16384);
 				if (!bankfiles[bank]){
 					sprintf(strptr,".nes.%X.nl",bank);
-					bankfiles[bank]=fopen(filename,"w");
+					bankfiles[bank]=openoutput(filename,"w");
 				}
 				fwrite((const void *)str,1,strlen(str),bankfiles[bank]);
 			}
@@ -1269,6 +1839,7 @@ void export_labelfiles() {
 	}
 
 	fclose ( ramfile );
+	free(list);
 
 	for(i=0;i<64;i++){
 		if(bankfiles[i]) fclose(bankfiles[i]);
@@ -1281,16 +1852,18 @@ void export_lua() {
 
 	int i;
 	label *l;
+	label **list;
 	char str[512];
 	char* filename;
 	FILE* mainfile;
 	
 	filename = replace_ext(outputfilename, ".lua");
-	mainfile=fopen(filename, "w");
+	mainfile=openoutput(filename, "w");
 	free(filename);
 
-	for(i=labelstart;i<=labelend;i++){
-		l=labellist[i];
+	list=sortedlabels(comparelabelnames);
+	for(i=0;i<labels;i++){
+		l=list[i];
 
 		if( 
 			(
@@ -1307,6 +1880,7 @@ void export_lua() {
 	}
 
 	fclose ( mainfile );
+	free(list);
 }
 
 int comparelabels(const void* arg1, const void* arg2)
@@ -1322,6 +1896,47 @@ int comparelabels(const void* arg1, const void* arg2)
 	return strcmp(a->name, b->name);
 }
 
+int comparelabelnames(const void* arg1, const void* arg2)
+{
+	const label* a = *((label**)arg1);
+	const label* b = *((label**)arg2);
+	return strcmp(a->name, b->name);
+}
+
+// returns a newly allocated array of all labels (the newest one for each name), sorted with cmp.
+label** sortedlabels(int (*cmp)(const void*, const void*))
+{
+	int i, n = 0;
+	label** list = (label**)my_malloc(labels * sizeof(label*));
+	for(i = 0; i < maxlabels; i++) {
+		if(labelnames[i].name)
+			list[n++] = labelnames[i].newest;
+	}
+	qsort(list, n, sizeof(label*), cmp);
+	return list;
+}
+
+// returns a newly allocated (unsorted) array of every symbol, including all the local labels that share a name
+label** allsymbols(int *count)
+{
+	int i, n = 0, max = labels + 16;
+	label *l;
+	label** list = (label**)my_malloc(max * sizeof(label*));
+	for(i = 0; i < maxlabelchains; i++)
+		for(l = labellist[i].name ? labellist[i].chain : 0; l; l = (label*)l->link)
+			if(l->type == LABEL || l->type == VALUE || l->type == EQUATE) {
+				if(n == max) {
+					max *= 2;
+					list = (label**)realloc(list, max * sizeof(label*));
+					if(!list)
+						fatal_error("out of memory");
+				}
+				list[n++] = l;
+			}
+	*count = n;
+	return list;
+}
+
 int comparecomments(const void* arg1, const void* arg2)
 {
 	const comment* a = *((comment**)arg1);
@@ -1337,21 +1952,22 @@ void export_mesenlabels() {
 	int i;
 	char* commenttext;
 	label *l;
+	label **list;
 	char str[512];
 	char* filename;
 	FILE* outfile;
 
 	filename = replace_ext(outputfilename, ".mlb");
-	outfile = fopen(filename, "w");
+	outfile = openoutput(filename, "w");
 	free(filename);
 
 	int currentcomment = 0;
 
-	qsort(labellist + labelstart, labelend - labelstart + 1, sizeof(label*), comparelabels);
+	list = sortedlabels(comparelabels);
 	qsort(comments, commentcount, sizeof(comment*), comparecomments);
 
-	for(i = labelstart; i<=labelend; i++) {
-		l = labellist[i];
+	for(i = 0; i<labels; i++) {
+		l = list[i];
 
 		if(l->value >= 0x10000 || l->name[0] == '+' || l->name[0] == '-' || l->value < 0) {
 			//Ignore CHR & anonymous code labels
@@ -1416,6 +2032,7 @@ void export_mesenlabels() {
 	}
 
 	fclose(outfile);
+	free(list);
 }
 
 //local:
@@ -1431,9 +2048,7 @@ void addlabel(char *word, int local) {
 		scope=nextscope++;
 	}
 	if(!p) {//new label
-		labelhere=newlabel();
-		if(!(*labelhere).name)//name already set if it's a duplicate
-			(*labelhere).name=my_strdup(word);
+		labelhere=newlabel((c==LOCALCHAR || local) ? scope : 0);
 		(*labelhere).type=LABEL;//assume it's a label.. could mutate into something else later
 		(*labelhere).pass=pass;
 		(*labelhere).value=addr;
@@ -1446,11 +2061,6 @@ void addlabel(char *word, int local) {
 		// [freem addition]
 		(*labelhere).ignorenl=nonl;
 
-		if(c==LOCALCHAR || local) { //local
-			(*labelhere).scope=scope;
-		} else {		//global
-			(*labelhere).scope=0;
-		}
 		lastlabel=labelhere;
 	} else {//old label
 		labelhere=p;
@@ -1464,6 +2074,8 @@ void addlabel(char *word, int local) {
 			if((*p).type==LABEL) {
 				if((*p).value!=addr && c!='-') {
 					needanotherpass=1;//label position is still moving around
+					if(passreport)
+						passnote(NOTE_MOVED,(*p).name,(*p).value,addr);
 					if(lastchance)
 						errmsg=BadAddr;
 				}
@@ -1482,19 +2094,22 @@ void initlabels(void) {
 	label *p;
 	int i=0;
 	
-	labels=1;
-	labellist=(label**)my_malloc(INITLISTSIZE*sizeof(label*));
-	labelstart=INITLISTSIZE/2;
-	labelend=labelstart;
+	labels=0;
 	maxlabels=INITLISTSIZE;
-	labellist[labelstart]=&firstlabel;//'$' label
+	labelnames=(labelname*)my_malloc(maxlabels*sizeof(labelname));
+	memset(labelnames,0,maxlabels*sizeof(labelname));
+	labelchains=0;
+	maxlabelchains=INITLISTSIZE;
+	labellist=(labelslot*)my_malloc(maxlabelchains*sizeof(labelslot));
+	memset(labellist,0,maxlabelchains*sizeof(labelslot));
+	findlabel((char*)firstlabel.name);
+	addlabelchain(internname(),&firstlabel);//'$' label
 	
 	//add reserved words to label list
 	
 	do {//opcodes first
 		findlabel(rsvdlist[i]);//must call findlabel before using newlabel
-		p=newlabel();
-		(*p).name=rsvdlist[i];
+		p=newlabel(0);
 		(*p).value=(ptrdiff_t)opcode;
 		(*p).line=rsvdlist[i+1];
 		(*p).type=RESERVED;
@@ -1504,8 +2119,7 @@ void initlabels(void) {
 	i = 0;
 	do {//other reserved words now
 		findlabel(directives[i].name);
-		p=newlabel();
-		(*p).name=directives[i].name;
+		p=newlabel(0);
 		(*p).value=(ptrdiff_t)directives[i].func;
 		(*p).type=RESERVED;
 		i++;
@@ -1529,13 +2143,8 @@ void growcommentlist(void) {
 	}
 }
 
+//comments live in passarena, so the list is emptied at the start of every pass
 void addcomment(char* text) {
-	static int oldpass = 0;
-	if(oldpass != pass) {
-		oldpass = pass;
-		commentcount = 0;
-	}
-
 	text++; //ignore the leading ";"
 
 	if(lastcommentpos == filepos) {
@@ -1543,7 +2152,7 @@ void addcomment(char* text) {
 		comment* c = comments[commentcount - 1];
 		char* oldtext = c->text;
 		int oldtextlen = strlen(oldtext);
-		char* newtext = my_malloc(oldtextlen + strlen(text) + 4);
+		char* newtext = (char*)arena_alloc(&passarena, oldtextlen + strlen(text) + 4, MEM_COMMENTS);
 		strcpy(newtext, oldtext);
 		strcpy(newtext + oldtextlen, "\\n");
 		
@@ -1555,9 +2164,9 @@ void addcomment(char* text) {
 		//Add a new comment
 		growcommentlist();
 
-		comment* c = (comment*)my_malloc(sizeof(comment));
+		comment* c = (comment*)arena_alloc(&passarena, sizeof(comment), MEM_COMMENTS);
 		c->pos = filepos;
-		c->text = my_malloc(strlen(text)+1);
+		c->text = (char*)arena_alloc(&passarena, strlen(text)+1, MEM_COMMENTS);
 		strcpy(c->text, text);		
 		
 		//Get rid of last character (newline \n)
@@ -1570,177 +2179,1492 @@ void addcomment(char* text) {
 	}
 }
 
+//hash a label name (FNV-1a)
+static unsigned hashname(const char *name) {
+	unsigned h=2166136261u;
+	while(*name)
+		h=(h^(byte)*name++)*16777619u;
+	return h;
+}
+
+//find the interned entry for name, or NULL if it was never used
+labelname *lookupname(char *name,unsigned hash) {
+	unsigned mask=maxlabels-1;
+	int i=hash&mask;
+	while(labelnames[i].name) {
+		if(labelnames[i].hash==hash && !strcmp(name,labelnames[i].name))
+			return &labelnames[i];
+		i=(i+1)&mask;
+	}
+	return 0;
+}
+
+static unsigned chainhash(unsigned namehash,int scope) {
+	return namehash^((unsigned)scope*2654435761u);
+}
+
+//find the chain of labels with this (interned) name and scope
+label *labelchain(labelname *n,int scope) {
+	unsigned mask=maxlabelchains-1;
+	unsigned h=chainhash(n->hash,scope);
+	int i=h&mask;
+	while(labellist[i].name) {
+		if(labellist[i].name==n->name && labellist[i].scope==scope)
+			return labellist[i].chain;
+		i=(i+1)&mask;
+	}
+	return 0;
+}
+
 //find label with this name
 //returns label* if found (and scope/etc is correct), returns NULL if nothing found
-//if name wasn't found, findindex points to where name would be inserted (name<labellist[findindex])
-//if name was found but with wrong scope/whatever, findcmp=0.
-//don't call if list is empty!
-int findcmp;		//(these are used by newlabel)
-int findindex;	  //.
-label *findlabel(char *name) {
-	int head,tail;
+//findname/findstr/findhash are left describing name, for newlabel.
+static label *lookuplabel(char *name) {
 	label *p, *global;
 
-	head=labelstart;
-	tail=labelend;
-	findindex=labelstart+labels/2;
-	do {//assume list isn't empty
-		findcmp=strcmp(name,(*(labellist[findindex])).name);
-		if(findcmp<0) {
-			tail=findindex-1;
-			findindex-=(tail-head)/2+1;
-		} else if(findcmp>0) {
-			head=findindex+1;
-			findindex+=(tail-head)/2+1;
-		}
-	} while(findcmp && (tail-head)>=0);
-	if(findcmp) {
-		if(findcmp<0)
-			findindex++;//position findindex so the label it points to needs to shift right
+	findhash=hashname(name);
+	findstr=name;
+	findname=lookupname(name,findhash);
+	if(!findname)
 		return 0;
-	}
-	p=labellist[findindex];
 
 	//check scope: label only visible if p.scope=(scope or 0)
 	global=0;
 	if(*name=='+') {//forward labels need special treatment :P
-		do {
-			if((*p).pass!=pass) {
-				if(!(*p).scope)
+		for(p=labelchain(findname,scope);p;p=(*p).link)
+			if((*p).pass!=pass)
+				return p;
+		if(scope)
+			for(p=labelchain(findname,0);p;p=(*p).link)
+				if((*p).pass!=pass)
 					global=p;
-				if((*p).scope==scope)
-					return p;
-			}
-			p=(*p).link;
-		} while(p);
 	} else {
-		do {
-			if(!(*p).scope)
-				global=p;
-			if((*p).scope==scope)
-				return p;
-			p=(*p).link;
-		} while(p);
+		if((p=labelchain(findname,scope)))
+			return p;
+		for(p=labelchain(findname,0);p;p=(*p).link)
+			global=p;
 	}
 	return global;  //return global label only if no locals were found
 }
 
-//double list capacity
-void growlist(void) {
-	label **tmp;
-	int newhead;
-	
-	maxlabels<<=1;
-	newhead=maxlabels/2-labels/2;
-	tmp=(label**)my_malloc(maxlabels*sizeof(label*));
-	memcpy(tmp+newhead,labellist+labelstart,labels*sizeof(label*));
-	free(labellist);
-	labellist=tmp;
-	findindex=findindex-labelstart+newhead;
-	labelstart=newhead;
-	labelend=newhead+labels-1;
+label *findlabel(char *name) {
+	label *p=lookuplabel(name);
+	if(memorec)
+		memo_dep(name,p);
+	if(pchrec)
+		pch_dep(name,p);
+	return p;
 }
 
-//make new empty label and add it to list using result from last findlabel
-//ONLY use after calling findlabel
-label *newlabel(void) {
-	label **start,**end;
-	label *p;
+//double capacity of the name table
+void grownames(void) {
+	labelname *old=labelnames;
+	int oldmax=maxlabels;
+	unsigned mask;
+	int i,j;
 
-	p=(label*)my_malloc(sizeof(label));
-	(*p).link=0;
-	(*p).scope=0;
-	(*p).name=0;
-
-	if(!findcmp) {//new label with same name
-		(*p).name=(*labellist[findindex]).name;//share old name
-		//if(!scope) {//global always goes at the end
-		//  (*lastfindlink).link=p;//add to the chain..
-		//} else {//insert into the front
-			(*p).link=labellist[findindex];
-			labellist[findindex]=p;
-		//}
-		return p;
+	maxlabels<<=1;
+	mask=maxlabels-1;
+	labelnames=(labelname*)my_malloc(maxlabels*sizeof(labelname));
+	memset(labelnames,0,maxlabels*sizeof(labelname));
+	for(i=0;i<oldmax;i++) {
+		if(!old[i].name)
+			continue;
+		for(j=old[i].hash&mask;labelnames[j].name;j=(j+1)&mask);
+		labelnames[j]=old[i];
 	}
-	if(!labelstart || labelend>=maxlabels-1)//make sure there's room to add
-		growlist();
+	free(old);
+}
+
+//double capacity of the chain table
+void growlist(void) {
+	labelslot *old=labellist;
+	int oldmax=maxlabelchains;
+	unsigned mask;
+	int i,j;
+
+	maxlabelchains<<=1;
+	mask=maxlabelchains-1;
+	labellist=(labelslot*)my_malloc(maxlabelchains*sizeof(labelslot));
+	memset(labellist,0,maxlabelchains*sizeof(labelslot));
+	for(i=0;i<oldmax;i++) {
+		if(!old[i].name)
+			continue;
+		for(j=old[i].hash&mask;labellist[j].name;j=(j+1)&mask);
+		labellist[j]=old[i];
+	}
+	free(old);
+}
+
+//intern the name from the last findlabel, if it isn't already
+labelname *internname(void) {
+	unsigned mask;
+	int i;
 
-	end=&labellist[findindex];
-	if(findindex>(labelstart+labels/2)) {   //shift up
-		start=&labellist[labelend];
-		for(;start>=end;start--)
-			*(start+1)=*start;
-		labelend++;
-	} else {				//shift down
-		end--;
-		start=&labellist[labelstart];
-		for(;start<=end;start++)
-			*(start-1)=*start;
-		labelstart--;
-	}
-	*end=p;
+	if(findname)
+		return findname;
+	if((labels+1)*2>maxlabels)//keep the table at most half full
+		grownames();
+	mask=maxlabels-1;
+	for(i=findhash&mask;labelnames[i].name;i=(i+1)&mask);
+	labelnames[i].name=arena_strdup(&asmarena,findstr,MEM_NAMES);
+	labelnames[i].hash=findhash;
+	labelnames[i].newest=0;
 	labels++;
+	findname=&labelnames[i];
+	return findname;
+}
+
+//put p at the front of the chain for its name and scope
+void addlabelchain(labelname *n,label *p) {
+	unsigned mask,h;
+	int i;
+
+	if((labelchains+1)*2>maxlabelchains)
+		growlist();
+	mask=maxlabelchains-1;
+	h=chainhash(n->hash,(*p).scope);
+	for(i=h&mask;labellist[i].name;i=(i+1)&mask) {
+		if(labellist[i].name==n->name && labellist[i].scope==(*p).scope)
+			break;
+	}
+	if(!labellist[i].name) {
+		labellist[i].name=n->name;
+		labellist[i].scope=(*p).scope;
+		labellist[i].hash=h;
+		labellist[i].chain=0;
+		labelchains++;
+	}
+	(*p).name=n->name;
+	(*p).link=labellist[i].chain;
+	labellist[i].chain=p;
+	n->newest=p;
+}
+
+//make new empty label in the given scope, using the name from last findlabel
+//ONLY use after calling findlabel
+label *newlabel(int labelscope) {
+	label *p;
+	labelname *n;
+
+	if(findname && findname->newest && (*findname->newest).type==RESERVED)
+		rsvdshadowed=1;//lexline() hints can't be trusted anymore
+	n=internname();
+	p=(label*)arena_alloc(&asmarena,sizeof(label),MEM_LABELS);
+	(*p).scope=labelscope;
+	addlabelchain(n,p);
 	return p;
 }
 
+//--watch starts every build from the symbol table as it was before the first one
+//(reserved words and -d symbols) instead of building it again.
+typedef struct {
+	label *p;
+	label saved;
+} savedlabel;
+
+arenamark asmstart;//asmarena before the first build
+labelname *startnames;
+int startlabels,startmaxlabels;
+labelslot *startlist;
+int startchains,startmaxchains;
+label *startlastlabel;
+int startshadowed;
+savedlabel *startsyms;
+int startsymcount;
+
+void save_symbols(void) {
+	label *p;
+	int i,n=0;
+
+	asmstart=arena_mark(&asmarena);
+	startnames=(labelname*)my_malloc(maxlabels*sizeof(labelname));
+	memcpy(startnames,labelnames,maxlabels*sizeof(labelname));
+	startlabels=labels;
+	startmaxlabels=maxlabels;
+	startlist=(labelslot*)my_malloc(maxlabelchains*sizeof(labelslot));
+	memcpy(startlist,labellist,maxlabelchains*sizeof(labelslot));
+	startchains=labelchains;
+	startmaxchains=maxlabelchains;
+	startlastlabel=lastlabel;
+	startshadowed=rsvdshadowed;
+	for(i=0;i<maxlabelchains;i++)
+		for(p=labellist[i].chain;p;p=(*p).link)
+			n++;
+	startsyms=(savedlabel*)my_malloc(n*sizeof(savedlabel));
+	for(i=0;i<maxlabelchains;i++)
+		for(p=labellist[i].chain;p;p=(*p).link) {
+			startsyms[startsymcount].p=p;
+			startsyms[startsymcount].saved=*p;
+			startsymcount++;
+		}
+}
+
+//drop every label, macro and equate made since save_symbols()
+void restore_symbols(void) {
+	int i;
+
+	arena_release(&asmarena,asmstart);
+	free(labelnames);
+	labelnames=(labelname*)my_malloc(startmaxlabels*sizeof(labelname));
+	memcpy(labelnames,startnames,startmaxlabels*sizeof(labelname));
+	labels=startlabels;
+	maxlabels=startmaxlabels;
+	free(labellist);
+	labellist=(labelslot*)my_malloc(startmaxchains*sizeof(labelslot));
+	memcpy(labellist,startlist,startmaxchains*sizeof(labelslot));
+	labelchains=startchains;
+	maxlabelchains=startmaxchains;
+	lastlabel=startlastlabel;
+	rsvdshadowed=startshadowed;
+	for(i=0;i<startsymcount;i++)
+		*startsyms[i].p=startsyms[i].saved;
+}
+
 //==============================================================================================================
 
 void showerror(char *errsrc,int errline) {
 	error=1;
-	fprintf(stderr,"%s(%i): %s\n",errsrc,errline,errmsg);
+	diagnostic("%s(%i): %s\n",errsrc,errline,errmsg);
 	
 	if(!listerr)//only list the first error for this line
 		listerr=errmsg;
 }
 
-//process the open file f
-char fileline[LINEMAX];
-void processfile(FILE *f, char* name) {
-	static int nest=0;
-	int nline=0;
-	int eof;
-	nest++;//count nested include()s
-	do {
-		nline++;
-		eof=!fgets(fileline,LINEMAX,f);		 
-		if(!eof)
-			processline(fileline,name,nline);
-	} while(!eof);
-	nest--;
-	nline--;
-	if(!nest) {//if main source file (not included)
-		errmsg=0;
-		if(iflevel)
-			errmsg=NoENDIF;
-		if(reptcount)
-			errmsg=NoENDR;
-		if(makemacro)
-			errmsg=NoENDM;
-		if(nooutput)
-			errmsg=NoENDE;
-		// [freem addition]
-		if(nonl)
-			errmsg=NoENDINL;
-		if(errmsg)
-			showerror(name,nline);
-	}
+//source file cache: every INCLUDEd file is read from disk once and split into
+//lines once, then later passes just walk the cached line array.
+//each file has its own arena, so --watch can reload only the files that changed.
+typedef struct sourcefile_t {
+	char *name;			//name as given to INCLUDE
+	char *text;			//file contents, each line NUL-terminated (keeping its '\n')
+	srcline *lines;
+	int linecount;
+	int busy;			//being processed right now (recursion check)
+	long size;			//size and modification time when the file was read
+	time_t mtime;
+	unsigned long long hash;	//of the contents (hashdata)
+	arena mem;			//name, text, lines and their tokens
+	struct sourcefile_t *next;
+} sourcefile;
+
+sourcefile *sourcefiles=0;
+
+//INCBIN/INCNES/INCINES files, also read from disk only once
+typedef struct binfile_t {
+	char *name;
+	byte *data;
+	long size;
+	time_t mtime;
+	unsigned long long hash;
+	struct binfile_t *next;
+} binfile;
+
+binfile *binfiles=0;
+
+//get size and modification time of a file. returns 0 if it's not there.
+static int filestamp(const char *name,long *size,time_t *mtime) {
+	struct stat st;
+	if(stat(name,&st))
+		return 0;
+	*size=(long)st.st_size;
+	*mtime=st.st_mtime;
+	return 1;
 }
 
-//process single line
-//src=source line
-//errsrc=source file name
-//errline=source file line number
-void processline(char *src,char *errsrc,int errline) {
-	char line[LINEMAX];//expanded line
-	char word[WORDMAX];
-	char *s,*s2,*comment;
-	char *endmac;
+//FNV-1a hash of size bytes of data
+static unsigned long long hashdata(const void *data,long size) {
+	unsigned long long h=14695981039346656037ULL;
+	long i;
+	for(i=0;i<size;i++)
+		h=(h^((const byte*)data)[i])*1099511628211ULL;
+	return h;
+}
+
+static void hashhex(char *dst,unsigned long long h) {
+	sprintf(dst,"%08lx%08lx",(unsigned long)(h>>32),(unsigned long)(h&0xffffffff));
+}
+
+//files handed over by asm6f_assemble(), looked for before the disk
+const asm6f_options *libfiles=0;
+int libfilesused=0;
+
+//copy a file from memory (my_malloc'd)
+static char *copyfile(const void *src,long size) {
+	char *data=my_malloc(size+1);
+	memcpy(data,src,size);
+	libfilesused=1;
+	return data;
+}
+
+//read a whole file (my_malloc'd), NULL if it can't be read
+static char *readfile(const char *name,long *size,time_t *mtime) {
+	FILE *f;
+	char *data;
+	const void *src;
+	int i;
+
+	if(libfiles) {
+		*mtime=0;
+		for(i=0;i<libfiles->filecount;i++)
+			if(!strcmp(libfiles->files[i].name,name)) {
+				*size=libfiles->files[i].size;
+				return copyfile(libfiles->files[i].data,*size);
+			}
+		if(libfiles->read && libfiles->read(libfiles->user,name,&src,size) && *size>=0)
+			return copyfile(src,*size);
+	}
+	if(!filestamp(name,size,mtime))//(stamp first, so a write during the read is seen as a change)
+		return 0;
+	if(!(f=fopen(name,"rb")))
+		return 0;
+	fseek(f,0,SEEK_END);
+	*size=ftell(f);
+	fseek(f,0,SEEK_SET);
+	if(*size<0) {
+		fclose(f);
+		return 0;
+	}
+	data=my_malloc(*size+1);
+	if(fread(data,1,*size,f)<(size_t)*size) {
+		free(data);
+		fclose(f);
+		return 0;
+	}
+	fclose(f);
+	return data;
+}
+
+//split raw file data into lines the same way fgets(LINEMAX) would,
+//except that "\r\n" line endings are normalized to "\n".
+static void splitlines(sourcefile *sf, char *data, size_t size) {
+	size_t i,len,maxlines;
+	int n=0;
+	char *dst;
+
+	maxlines=size/(LINEMAX-1)+1;
+	for(i=0;i<size;i++)
+		if(data[i]=='\n')
+			maxlines++;
+	sf->text=(char*)arena_alloc(&sf->mem,size+maxlines,MEM_SOURCE);
+	sf->lines=(srcline*)arena_alloc(&sf->mem,maxlines*sizeof(srcline),MEM_SOURCE);
+	dst=sf->text;
+	i=0;
+	while(i<size) {
+		sf->lines[n].text=dst;
+		sf->lines[n].lexed=0;
+		n++;
+		len=0;
+		while(i<size && len<LINEMAX-1) {
+			if(data[i]=='\r' && i+1<size && data[i+1]=='\n')
+				i++;
+			dst[len++]=data[i];
+			if(data[i++]=='\n')
+				break;
+		}
+		dst[len]=0;
+		dst+=len+1;
+	}
+	sf->linecount=n;
+}
+
+static sourcefile *loadsourcefile(char *name) {
+	sourcefile *sf;
+	char *data;
+	long size;
+	time_t mtime;
+	int i;
+
+	for(sf=sourcefiles;sf;sf=sf->next)
+		if(!strcmp(sf->name,name))
+			return sf;
+
+	if(!(data=readfile(name,&size,&mtime)))
+		return 0;
+	sf=(sourcefile*)my_malloc(sizeof(sourcefile));
+	memset(sf,0,sizeof(sourcefile));
+	sf->name=arena_strdup(&sf->mem,name,MEM_SOURCE);
+	sf->size=size;
+	sf->mtime=mtime;
+	sf->hash=hashdata(data,size);
+	splitlines(sf,data,size);
+	free(data);
+	for(i=0;i<sf->linecount;i++)//(lexed now so the tokens live in the file's arena)
+		lexline(&sf->lines[i],&sf->mem,MEM_SOURCE);
+	sf->next=sourcefiles;
+	sourcefiles=sf;
+	return sf;
+}
+
+//find name in the source cache, reading it from disk if it's not there yet.
+//returns NULL if the file can't be read.
+sourcefile *getsourcefile(char *name) {
+	sourcefile *sf=loadsourcefile(name);
+	if(cacherec)
+		cache_input(name,sf!=0,sf ? sf->hash : 0);
+	return sf;
+}
+
+static binfile *loadbinfile(char *name) {
+	binfile *bf;
+	byte *data;
+	long size;
+	time_t mtime;
+
+	for(bf=binfiles;bf;bf=bf->next)
+		if(!strcmp(bf->name,name))
+			return bf;
+
+	if(!(data=(byte*)readfile(name,&size,&mtime)))
+		return 0;
+	bf=(binfile*)my_malloc(sizeof(binfile));
+	bf->name=my_malloc(strlen(name)+1);
+	strcpy(bf->name,name);
+	bf->data=data;
+	bf->size=size;
+	bf->mtime=mtime;
+	bf->hash=hashdata(data,size);
+	bf->next=binfiles;
+	binfiles=bf;
+	return bf;
+}
+
+//find name in the binary file cache, reading it from disk if it's not there yet.
+//returns NULL if the file can't be read.
+binfile *getbinfile(char *name) {
+	binfile *bf=loadbinfile(name);
+	if(cacherec)
+		cache_input(name,bf!=0,bf ? bf->hash : 0);
+	return bf;
+}
+
+//--pch: an INCLUDEd file that only defines symbols (EQU, =, MACRO) is saved as a
+//snapshot of what it defines, named by a hash of its contents. including the same
+//contents again (on a later pass or in a later build) loads the snapshot instead of
+//reading and assembling the file.
+char *pchdir=0;//where snapshots are kept (--pch)
+
+typedef struct pchfile_t {
+	char *name;			//name as given to INCLUDE
+	long size;
+	time_t mtime;
+	unsigned long long hash;	//of the contents
+	char hashname[17];	//(in hex)
+	byte *data;			//snapshot (my_malloc'd), NULL if there isn't one
+	long datasize;
+	int recorded;		//already tried to record a snapshot
+	struct pchfile_t *next;
+} pchfile;
+
+pchfile *pchfiles=0;
+
+//snapshot being recorded (pchrec)
+int pchnest;			//includenest of the file's own lines
+int pchpure;			//nothing outside of EQU/=/MACRO has happened yet
+int pchneed,pchcomments,pchaddr,pchfilepos,pchstarted;
+label **pchown;			//labels the file defined (hash set), in pchorder too
+int pchownmax;
+label **pchorder;
+int pchowncount;
+char *pchabsent;		//names looked up that weren't there (hash set of offsets into pchnames)
+int *pchabsentset;
+int pchabsentmax,pchabsentcount;
+char *pchnames;
+int pchnameslen,pchnamesmax;
+
+#define PCHMAGIC "asm6f pch " VERSION "\n"
+
+static pchfile *loadpchfile(char *name) {
+	pchfile *pf;
+	char path[LINEMAX];
+	char *data;
+	long size;
+	time_t mtime;
+
+	for(pf=pchfiles;pf;pf=pf->next)
+		if(!strcmp(pf->name,name))
+			return pf;
+
+	if(!(data=readfile(name,&size,&mtime)))
+		return 0;
+	pf=(pchfile*)my_malloc(sizeof(pchfile));
+	memset(pf,0,sizeof(pchfile));
+	pf->name=my_malloc(strlen(name)+1);
+	strcpy(pf->name,name);
+	pf->size=size;
+	pf->mtime=mtime;
+	pf->hash=hashdata(data,size);
+	free(data);
+	hashhex(pf->hashname,pf->hash);
+	if(snprintf(path,sizeof(path),"%s/%s.pch",pchdir,pf->hashname)<(int)sizeof(path)) {
+		if((pf->data=(byte*)readfile(path,&pf->datasize,&mtime))) {
+			if(pf->datasize<(long)strlen(PCHMAGIC) || memcmp(pf->data,PCHMAGIC,strlen(PCHMAGIC))) {
+				free(pf->data);//(from another version)
+				pf->data=0;
+			}
+		}
+	}
+	pf->next=pchfiles;
+	pchfiles=pf;
+	return pf;
+}
+
+//find name in the snapshot cache, reading it (and its snapshot, if there is one)
+//if it's not there yet. returns NULL if the file can't be read.
+pchfile *getpchfile(char *name) {
+	pchfile *pf=loadpchfile(name);
+	if(cacherec)
+		cache_input(name,pf!=0,pf ? pf->hash : 0);
+	return pf;
+}
+
+static void pchfree(pchfile *pf) {
+	free(pf->name);
+	free(pf->data);
+	free(pf);
+}
+
+static unsigned pchptrhash(label *p) {
+	return (unsigned)(((size_t)p>>4)*2654435761u);
+}
+
+static int pch_isown(label *p) {
+	unsigned mask=pchownmax-1,i;
+	for(i=pchptrhash(p)&mask;pchown[i];i=(i+1)&mask)
+		if(pchown[i]==p)
+			return 1;
+	return 0;
+}
+
+static void pch_addown(label *p) {
+	unsigned mask,i;
+	int j;
+	if(pch_isown(p))
+		return;
+	if((pchowncount+1)*2>pchownmax) {
+		free(pchown);
+		pchownmax*=2;
+		pchown=(label**)my_malloc(pchownmax*sizeof(label*));
+		memset(pchown,0,pchownmax*sizeof(label*));
+		pchorder=(label**)realloc(pchorder,pchownmax*sizeof(label*));
+		if(!pchorder)
+			fatal_error("out of memory");
+		for(j=0;j<pchowncount;j++) {
+			for(i=pchptrhash(pchorder[j])&(pchownmax-1);pchown[i];i=(i+1)&(pchownmax-1));
+			pchown[i]=pchorder[j];
+		}
+	}
+	mask=pchownmax-1;
+	for(i=pchptrhash(p)&mask;pchown[i];i=(i+1)&mask);
+	pchown[i]=p;
+	pchorder[pchowncount++]=p;
+}
+
+//remember that name was looked up and not found
+static void pch_addabsent(char *name) {
+	unsigned mask,h=hashname(name),i;
+	int j,len=strlen(name)+1;
+	mask=pchabsentmax-1;
+	for(i=h&mask;pchabsentset[i]>=0;i=(i+1)&mask)
+		if(!strcmp(pchnames+pchabsentset[i],name))
+			return;
+	if(pchnameslen+len>pchnamesmax) {
+		pchnamesmax=(pchnameslen+len)*2;
+		pchnames=(char*)realloc(pchnames,pchnamesmax);
+		if(!pchnames)
+			fatal_error("out of memory");
+	}
+	memcpy(pchnames+pchnameslen,name,len);
+	pchabsentset[i]=pchnameslen;
+	pchnameslen+=len;
+	if(++pchabsentcount*2>pchabsentmax) {
+		int *old=pchabsentset;
+		pchabsentmax*=2;
+		mask=pchabsentmax-1;
+		pchabsentset=(int*)my_malloc(pchabsentmax*sizeof(int));
+		memset(pchabsentset,-1,pchabsentmax*sizeof(int));
+		for(j=0;j<pchabsentmax/2;j++)
+			if(old[j]>=0) {
+				for(i=hashname(pchnames+old[j])&mask;pchabsentset[i]>=0;i=(i+1)&mask);
+				pchabsentset[i]=old[j];
+			}
+		free(old);
+	}
+}
+
+//findlabel(name) returned p while recording
+void pch_dep(char *name,label *p) {
+	if(!pchpure)
+		return;
+	if(!p)
+		pch_addabsent(name);//(must not be there when the snapshot is loaded)
+	else if((*p).type!=RESERVED && !pch_isown(p))
+		pchpure=0;//depends on something defined outside
+}
+
+//a line of the file being recorded was assembled. p=its directive, if any
+void pch_line(label *p) {
+	icfn fn;
+	if(!pchpure || includenest!=pchnest)
+		return;
+	fn=p ? (icfn)(*p).value : 0;
+	if(p && (*p).type==RESERVED && fn==nothing && !labelhere)
+		return;//(blank line)
+	if(!p || (*p).type!=RESERVED || (fn!=equ && fn!=equal && fn!=macro)
+	|| !labelhere || (*labelhere).scope || *(*labelhere).name=='+' || *(*labelhere).name=='-') {
+		pchpure=0;
+		return;
+	}
+	pch_addown(labelhere);
+}
+
+//start recording pf's snapshot, if it can be
+static int pch_start(pchfile *pf) {
+	pf->recorded=1;
+	if(pchrec || error || rsvdshadowed || insidemacro)
+		return 0;
+	pchrec=pf;
+	pchnest=includenest+1;
+	pchpure=1;
+	pchneed=needanotherpass;
+	needanotherpass=0;
+	pchcomments=commentcount;
+	pchaddr=addr;
+	pchfilepos=filepos;
+	pchstarted=outputstarted;
+	pchownmax=64;
+	pchowncount=0;
+	pchown=(label**)my_malloc(pchownmax*sizeof(label*));
+	memset(pchown,0,pchownmax*sizeof(label*));
+	pchorder=(label**)my_malloc(pchownmax*sizeof(label*));
+	pchabsentmax=64;
+	pchabsentcount=0;
+	pchabsentset=(int*)my_malloc(pchabsentmax*sizeof(int));
+	memset(pchabsentset,-1,pchabsentmax*sizeof(int));
+	pchnameslen=0;
+	return 1;
+}
+
+static void pch_put(byte **buf,long *len,long *max,const void *p,long size) {
+	if(*len+size>*max) {
+		*max=(*len+size)*2;
+		*buf=(byte*)realloc(*buf,*max);
+		if(!*buf)
+			fatal_error("out of memory");
+	}
+	memcpy(*buf+*len,p,size);
+	*len+=size;
+}
+
+static void pch_putnum(byte **buf,long *len,long *max,long long v) {
+	byte b[8];
+	int i;
+	for(i=0;i<8;i++)
+		b[i]=(byte)(v>>(i*8));
+	pch_put(buf,len,max,b,8);
+}
+
+static void pch_putstr(byte **buf,long *len,long *max,const char *s) {
+	pch_put(buf,len,max,s,strlen(s)+1);
+}
+
+//done assembling the file being recorded. saves the snapshot if it only defined symbols.
+//snapshot: PCHMAGIC, absent name count, names, symbol count, symbols:
+//type, name, then the equate text / value / macro param count, chain length, chain
+static void pch_finish(void) {
+	pchfile *pf=pchrec;
+	byte *buf=0;
+	long len=0,max=0;
+	label *p;
+	char **chain;
+	char path[LINEMAX];
+	int i,n;
+	FILE *f;
+
+	for(i=0;pchpure && i<pchowncount;i++) {
+		p=pchorder[i];
+		if((*p).type==VALUE && (*p).line!=true_ptr)
+			pchpure=0;//(value wasn't known)
+	}
+	if(pchpure && !error && !needanotherpass && pchowncount && commentcount==pchcomments
+	&& addr==pchaddr && filepos==pchfilepos && outputstarted==pchstarted) {
+		pch_put(&buf,&len,&max,PCHMAGIC,strlen(PCHMAGIC));
+		pch_putnum(&buf,&len,&max,pchabsentcount);
+		for(i=0;i<pchabsentmax;i++)
+			if(pchabsentset[i]>=0)
+				pch_putstr(&buf,&len,&max,pchnames+pchabsentset[i]);
+		pch_putnum(&buf,&len,&max,pchowncount);
+		for(i=0;i<pchowncount;i++) {
+			p=pchorder[i];
+			pch_putnum(&buf,&len,&max,(*p).type);
+			pch_putstr(&buf,&len,&max,(*p).name);
+			if((*p).type==EQUATE)
+				pch_putstr(&buf,&len,&max,(*p).line);
+			else if((*p).type==VALUE)
+				pch_putnum(&buf,&len,&max,(*p).value);
+			else {
+				pch_putnum(&buf,&len,&max,(*p).value);
+				n=0;
+				for(chain=(char**)((macrodef*)(*p).line)->text;chain;chain=(char**)*chain)
+					n++;
+				pch_putnum(&buf,&len,&max,n);
+				for(chain=(char**)((macrodef*)(*p).line)->text;chain;chain=(char**)*chain)
+					pch_putstr(&buf,&len,&max,(char*)&chain[1]);
+			}
+		}
+		pf->data=buf;
+		pf->datasize=len;
+		if(snprintf(path,sizeof(path),"%s/%s.pch",pchdir,pf->hashname)<(int)sizeof(path)) {
+			if((f=fopen(path,"wb"))) {//(it's only a cache, so failing to write it is fine)
+				if(fwrite(buf,1,len,f)<(size_t)len) {
+					fclose(f);
+					remove(path);
+				} else if(fclose(f))
+					remove(path);
+			}
+		}
+	}
+	needanotherpass|=pchneed;
+	free(pchown);
+	free(pchorder);
+	free(pchabsentset);
+	pchrec=0;
+}
+
+//read snapshot data at *pos, NULL/0 if it's cut short
+static const char *pch_getstr(pchfile *pf,long *pos) {
+	const char *s=(const char*)pf->data+*pos;
+	const char *end;
+	if(*pos>=pf->datasize || !(end=memchr(s,0,pf->datasize-*pos)))
+		return 0;
+	*pos=end+1-(const char*)pf->data;
+	return s;
+}
+
+static int pch_getnum(pchfile *pf,long *pos,long long *v) {
+	int i;
+	if(*pos+8>pf->datasize)
+		return 0;
+	*v=0;
+	for(i=7;i>=0;i--)
+		*v=(*v<<8)|pf->data[*pos+i];
+	*pos+=8;
+	return 1;
+}
+
+//define what pf's snapshot holds, as assembling the file would have.
+//returns 0 if it can't be used here (the file has to be assembled instead).
+int pch_apply(pchfile *pf) {
+	long pos,start;
+	long long n=0,i,type=0,v=0,count=0,j;
+	const char *name,*s;
+	label *p;
+	macrodef *md;
+	char **chain=0;
+	int fresh=-1;
+
+	if(rsvdshadowed || pchrec)
+		return 0;
+	//check first: every symbol must be new, or all left from an earlier pass
+	pos=strlen(PCHMAGIC);
+	if(!pch_getnum(pf,&pos,&n))
+		return 0;
+	for(i=0;i<n;i++)
+		if(!pch_getstr(pf,&pos))
+			return 0;
+	if(!pch_getnum(pf,&pos,&n))
+		return 0;
+	start=pos;
+	for(i=0;i<n;i++) {
+		if(!pch_getnum(pf,&pos,&type) || !(name=pch_getstr(pf,&pos)))
+			return 0;
+		p=lookuplabel((char*)name);
+		if(fresh<0)
+			fresh=!p;
+		if(fresh ? p!=0 : (!p || (*p).type!=type || (*p).scope || ((*p).type!=VALUE && (*p).pass==pass)))
+			return 0;
+		if(type==EQUATE) {
+			if(!pch_getstr(pf,&pos))
+				return 0;
+		} else if(type==VALUE) {
+			if(!pch_getnum(pf,&pos,&v))
+				return 0;
+		} else if(type==MACRO) {
+			if(!pch_getnum(pf,&pos,&v) || !pch_getnum(pf,&pos,&count))
+				return 0;
+			for(j=0;j<count;j++)
+				if(!pch_getstr(pf,&pos))
+					return 0;
+		} else
+			return 0;
+	}
+	if(fresh) {//the names it looked up that weren't there still mustn't be
+		pos=strlen(PCHMAGIC);
+		if(!pch_getnum(pf,&pos,&v))
+			return 0;
+		for(i=0;i<v;i++)
+			if(!(s=pch_getstr(pf,&pos)) || lookuplabel((char*)s))
+				return 0;
+	}
+
+	pos=start;
+	for(i=0;i<n;i++) {
+		if(!pch_getnum(pf,&pos,&type) || !(name=pch_getstr(pf,&pos)))
+			return 0;
+		scope=nextscope++;//(as addlabel does)
+		p=findlabel((char*)name);
+		if(fresh) {
+			p=newlabel(0);
+			(*p).type=type;
+			(*p).value=addr;
+			(*p).pos=filepos;
+			(*p).used=0;
+			(*p).ignorenl=nonl;
+			lastlabel=p;
+		}
+		(*p).pass=pass;
+		if(type==EQUATE) {
+			if(!(s=pch_getstr(pf,&pos)))
+				return 0;
+			if(fresh)
+				(*p).line=arena_strdup(&asmarena,s,MEM_EQUATES);
+		} else if(type==VALUE) {
+			if(!pch_getnum(pf,&pos,&v))
+				return 0;
+			(*p).value=v;
+			(*p).line=true_ptr;
+		} else {
+			if(!pch_getnum(pf,&pos,&v) || !pch_getnum(pf,&pos,&count))
+				return 0;
+			if(fresh) {
+				md=(macrodef*)arena_alloc(&asmarena,sizeof(macrodef),MEM_MACROS);
+				md->text=0;
+				md->lines=0;
+				(*p).value=v;
+				(*p).line=(char*)md;
+				chain=&md->text;
+			}
+			for(j=0;j<count;j++) {
+				if(!(s=pch_getstr(pf,&pos)))
+					return 0;
+				if(fresh) {
+					*chain=(char*)arena_alloc(&asmarena,strlen(s)+sizeof(char*)+1,MEM_MACROS);
+					chain=(char**)*chain;
+					*chain=0;
+					strcpy((char*)&chain[1],s);
+				}
+			}
+		}
+	}
+	return 1;
+}
+
+//--cache: a build is keyed by the options, the -d symbols and the contents of every
+//file it read. when nothing changed since a build that worked, its outputs are
+//copied back from the cache directory instead of assembling.
+//<key>.inputs lists the files the last build with those options read (and their
+//hashes), <key of options and inputs>.out holds everything it wrote.
+char *cachedir=0;//where builds are kept (--cache)
+
+typedef struct {
+	char *name;
+	int found;				//0 if the file wasn't there
+	unsigned long long hash;
+} cachefile;
+
+cachefile *cacheinputs=0,*cacheoutputs=0;
+int cacheinputcount=0,cacheoutputcount=0,cacheinputmax=0,cacheoutputmax=0;
+
+#define CACHEMAGIC "asm6f cache " VERSION "\n"
+
+static void cache_add(cachefile **list,int *count,int *max,const char *name,int found,unsigned long long hash) {
+	int i;
+	for(i=0;i<*count;i++)
+		if(!strcmp((*list)[i].name,name))
+			return;
+	if(*count==*max) {
+		*max=*max ? *max*2 : 64;
+		*list=(cachefile*)realloc(*list,*max*sizeof(cachefile));
+		if(!*list)
+			fatal_error("out of memory");
+	}
+	(*list)[*count].name=my_malloc(strlen(name)+1);
+	strcpy((*list)[*count].name,name);
+	(*list)[*count].found=found;
+	(*list)[*count].hash=hash;
+	(*count)++;
+}
+
+//the build read name (found=0 if it tried to and it wasn't there)
+void cache_input(char *name,int found,unsigned long long hash) {
+	cache_add(&cacheinputs,&cacheinputcount,&cacheinputmax,name,found,hash);
+}
+
+//fopen() for writing one of the outputs
+FILE *openoutput(const char *name,const char *mode) {
+	FILE *f=fopen(name,mode);
+	if(f && cacherec)
+		cache_add(&cacheoutputs,&cacheoutputcount,&cacheoutputmax,name,1,0);
+	return f;
+}
+
+static void cache_clear(void) {
+	int i;
+	for(i=0;i<cacheinputcount;i++)
+		free(cacheinputs[i].name);
+	for(i=0;i<cacheoutputcount;i++)
+		free(cacheoutputs[i].name);
+	cacheinputcount=cacheoutputcount=0;
+	cacherec=0;
+}
+
+//hash of what the build depends on besides its inputs
+static unsigned long long cache_optionkey(void) {
+	char key[LINEMAX*8];
+	char *names[]={inputfilename,outputfilename,listfilename,ipsfilename,cdlfilename,bpsfilename,upsfilename};
+	label **defs;
+	label *p;
+	int i,n=0,len;
+
+	len=sprintf(key,"%s%s %s %d %d %d %d %d %d %d %d %d %d\n",CACHEMAGIC,__DATE__,__TIME__,verboselisting,
+		genfceuxnl,genmesenlabels,gendbg,gencdl,genlua,genips,genbps,genups,allowunstable|allowhunstable<<1);
+	for(i=0;i<(int)(sizeof(names)/sizeof(names[0]));i++) {
+		if(names[i] && strlen(names[i])+len+2>=sizeof(key))
+			fatal_error("file name too long: %s",names[i]);
+		len+=sprintf(key+len,"%s\n",names[i] ? names[i] : "");
+	}
+	//the symbols defined before assembling (-d, --config)
+	defs=(label**)my_malloc(labels*sizeof(label*));
+	for(i=0;i<maxlabelchains;i++)
+		for(p=labellist[i].name ? labellist[i].chain : 0;p;p=(label*)p->link)
+			if(p!=&firstlabel && (*p).type==VALUE && !(*p).pass)
+				defs[n++]=p;
+	qsort(defs,n,sizeof(label*),comparelabelnames);
+	for(i=0;i<n;i++) {
+		if(strlen(defs[i]->name)+len+4>=sizeof(key))
+			fatal_error("too many symbols defined");
+		len+=sprintf(key+len,"-d%s\n",defs[i]->name);
+	}
+	free(defs);
+	return hashdata(key,len);
+}
+
+//hash of the options and every input (name, and hash of the contents)
+static unsigned long long cache_buildkey(unsigned long long optionkey,cachefile *inputs,int count) {
+	unsigned long long h=optionkey;
+	int i;
+	for(i=0;i<count;i++) {
+		h=(h^hashdata(inputs[i].name,strlen(inputs[i].name)))*1099511628211ULL;
+		h=(h^(inputs[i].found ? inputs[i].hash : 0))*1099511628211ULL;
+	}
+	return h;
+}
+
+static void cache_path(char *path,unsigned long long key,const char *ext) {
+	char hex[17];
+	hashhex(hex,key);
+	snprintf(path,LINEMAX+64,"%s/%s%s",cachedir,hex,ext);//(--cache made sure it fits)
+}
+
+//write data to name, through a temporary file so other processes never see half of it
+static int cache_write(const char *name,const void *data,long size) {
+	static int count=0;
+	char tmp[LINEMAX+32];
+	FILE *f;
+
+	sprintf(tmp,"%s.%lx%x.tmp",name,(unsigned long)(prof_now()*1000000),count++);
+	if(!(f=fopen(tmp,"wb")))
+		return 0;
+	if(fwrite(data,1,size,f)<(size_t)size) {
+		fclose(f);
+		remove(tmp);
+		return 0;
+	}
+	if(fclose(f)) {
+		remove(tmp);
+		return 0;
+	}
+	remove(name);//(rename() won't replace a file on windows)
+	if(rename(tmp,name)) {
+		remove(tmp);
+		return 0;
+	}
+	return 1;
+}
+
+//copy back the outputs of an earlier build with the same options and inputs.
+//returns 0 if there isn't one.
+static int cache_restore(unsigned long long optionkey) {
+	char path[LINEMAX+64];
+	char *list,*line,*next,*name,*data;
+	cachefile *inputs=0;
+	int count=0,max=0,i,ok=0;
+	long size,pos,len;
+	time_t mtime;
+	FILE *f;
+
+	cache_path(path,optionkey,".inputs");
+	if(!(list=readfile(path,&size,&mtime)))
+		return 0;
+	list[size]=0;
+	for(line=list;*line;line=next) {//each line is the hash (or "-" if it wasn't there) and the name
+		next=line+strcspn(line,"\n");
+		if(*next)
+			*next++=0;
+		if(!(name=strchr(line,' ')))
+			break;
+		*name++=0;
+		if((data=readfile(name,&len,&mtime))) {
+			cache_add(&inputs,&count,&max,name,1,hashdata(data,len));
+			free(data);
+		} else
+			cache_add(&inputs,&count,&max,name,0,0);
+		if(strcmp(line,"-") ? !inputs[count-1].found || strtoull(line,0,16)!=inputs[count-1].hash : inputs[count-1].found)
+			break;//(changed)
+	}
+	if(!*line) {
+		cache_path(path,cache_buildkey(optionkey,inputs,count),".out");
+		if((data=readfile(path,&size,&mtime))) {
+			pos=strlen(CACHEMAGIC);
+			if(size>=pos && !memcmp(data,CACHEMAGIC,pos)) {//outputs: name, 8 byte size, contents
+				ok=1;
+				while(ok && pos<size) {
+					name=data+pos;
+					pos+=strnlen(name,size-pos)+1;
+					if(pos+8>size) {
+						ok=0;
+						break;
+					}
+					for(len=0,i=7;i>=0;i--)
+						len=(len<<8)|(byte)data[pos+i];
+					pos+=8;
+					if(len<0 || pos+len>size) {
+						ok=0;
+						break;
+					}
+					if(!(f=fopen(name,"wb")) || fwrite(data+pos,1,len,f)<(size_t)len) {
+						ok=0;
+						if(f)
+							fclose(f);
+						break;
+					}
+					if(fclose(f))
+						ok=0;
+					message("%s restored from cache.\n",name);
+					pos+=len;
+				}
+			}
+			free(data);
+		}
+	}
+	for(i=0;i<count;i++)
+		free(inputs[i].name);
+	free(inputs);
+	free(list);
+	return ok;
+}
+
+static void cache_putnum(char **buf,long *len,long *max,long long v) {
+	int i;
+	if(*len+8>*max) {
+		*max=(*len+8)*2;
+		*buf=(char*)realloc(*buf,*max);
+		if(!*buf)
+			fatal_error("out of memory");
+	}
+	for(i=0;i<8;i++)
+		(*buf)[(*len)++]=(char)(v>>(i*8));
+}
+
+static void cache_put(char **buf,long *len,long *max,const void *data,long size) {
+	if(*len+size>*max) {
+		*max=(*len+size)*2;
+		*buf=(char*)realloc(*buf,*max);
+		if(!*buf)
+			fatal_error("out of memory");
+	}
+	memcpy(*buf+*len,data,size);
+	*len+=size;
+}
+
+//keep the inputs and outputs of the build that just worked
+static void cache_store(unsigned long long optionkey) {
+	char path[LINEMAX+64];
+	char hex[17];
+	char *buf=0,*data;
+	long len=0,max=0,size;
+	time_t mtime;
+	int i;
+
+	cache_put(&buf,&len,&max,CACHEMAGIC,strlen(CACHEMAGIC));
+	for(i=0;i<cacheoutputcount;i++) {
+		if(!(data=readfile(cacheoutputs[i].name,&size,&mtime))) {
+			free(buf);
+			return;
+		}
+		cache_put(&buf,&len,&max,cacheoutputs[i].name,strlen(cacheoutputs[i].name)+1);
+		cache_putnum(&buf,&len,&max,size);
+		cache_put(&buf,&len,&max,data,size);
+		free(data);
+	}
+	cache_path(path,cache_buildkey(optionkey,cacheinputs,cacheinputcount),".out");
+	if(cache_write(path,buf,len)) {
+		len=0;
+		for(i=0;i<cacheinputcount;i++) {
+			hashhex(hex,cacheinputs[i].hash);
+			cache_put(&buf,&len,&max,cacheinputs[i].found ? hex : "-",cacheinputs[i].found ? 16 : 1);
+			cache_put(&buf,&len,&max," ",1);
+			cache_put(&buf,&len,&max,cacheinputs[i].name,strlen(cacheinputs[i].name));
+			cache_put(&buf,&len,&max,"\n",1);
+		}
+		cache_path(path,optionkey,".inputs");
+		cache_write(path,buf,len);
+	}
+	free(buf);
+}
+
+//drop every cached file that changed on disk (or is gone) since it was read,
+//or every one if all is set, so the next build reads it again.
+//returns how many there were.
+int drop_changed_files(int all) {
+	sourcefile **sfp,*sf;
+	binfile **bfp,*bf;
+	pchfile **pfp,*pf;
+	long size;
+	time_t mtime;
+	int changed=0;
+
+	for(sfp=&sourcefiles;(sf=*sfp);) {
+		if(!all && filestamp(sf->name,&size,&mtime) && size==sf->size && mtime==sf->mtime) {
+			sfp=&sf->next;
+			continue;
+		}
+		if(watching)
+			printf("%s changed.\n",sf->name);
+		*sfp=sf->next;
+		arena_free(&sf->mem);
+		free(sf);
+		changed++;
+	}
+	for(bfp=&binfiles;(bf=*bfp);) {
+		if(!all && filestamp(bf->name,&size,&mtime) && size==bf->size && mtime==bf->mtime) {
+			bfp=&bf->next;
+			continue;
+		}
+		if(watching)
+			printf("%s changed.\n",bf->name);
+		*bfp=bf->next;
+		free(bf->name);
+		free(bf->data);
+		free(bf);
+		changed++;
+	}
+	for(pfp=&pchfiles;(pf=*pfp);) {//(not counted, the file is in the source cache too)
+		if(!all && filestamp(pf->name,&size,&mtime) && size==pf->size && mtime==pf->mtime) {
+			pfp=&pf->next;
+			continue;
+		}
+		*pfp=pf->next;
+		pchfree(pf);
+	}
+	return changed;
+}
+
+static void watch_sleep(int ms) {
+#ifdef _WIN32
+	Sleep(ms);
+#else
+	struct timespec ts;
+	ts.tv_sec=ms/1000;
+	ts.tv_nsec=(ms%1000)*1000000L;
+	nanosleep(&ts,0);
+#endif
+}
+
+#ifdef __linux__
+//watch the directory a file is in (editors often replace files instead of writing them)
+static void watch_dir(int fd,const char *name) {
+	char dir[LINEMAX];
+	const char *slash=strrchr(name,'/');
+	size_t len=slash ? (size_t)(slash-name) : 0;
+
+	if(!slash)
+		strcpy(dir,".");
+	else if(len>=LINEMAX)
+		return;
+	else {
+		memcpy(dir,name,len ? len : 1);//("/file" is in "/")
+		dir[len ? len : 1]=0;
+	}
+	inotify_add_watch(fd,dir,IN_CLOSE_WRITE|IN_MOVED_TO|IN_CREATE|IN_DELETE|IN_ATTRIB);
+}
+#endif
+
+//wait until one of the files the last build read changes, and drop it from the cache.
+//returns 0 if there's nothing to watch.
+int watch_files(void) {
+#ifdef __linux__
+	sourcefile *sf;
+	binfile *bf;
+	char events[4096];
+	int fd=inotify_init();
+
+	if(fd>=0) {
+		for(sf=sourcefiles;sf;sf=sf->next)
+			watch_dir(fd,sf->name);
+		for(bf=binfiles;bf;bf=bf->next)
+			watch_dir(fd,bf->name);
+	}
+#endif
+	if(!sourcefiles)
+		return 0;
+	printf("watching for changes..\n");
+	fflush(stdout);
+	for(;;) {
+#ifdef __linux__
+		if(fd>=0) {
+			if(read(fd,events,sizeof(events))<=0) {
+				close(fd);
+				fd=-1;
+			}
+		} else
+#endif
+			watch_sleep(250);
+		watch_sleep(20);//let the editor finish writing
+		if(drop_changed_files(0))
+			break;
+	}
+#ifdef __linux__
+	if(fd>=0)
+		close(fd);
+#endif
+	return 1;
+}
+
+//process the cached file sf
+void processfile(sourcefile *sf) {
+	int nline=0;
+	char *name=sf->name;
+	includenest++;//count nested include()s
+	sf->busy=1;
+	while(nline<sf->linecount) {
+		nline++;
+		processsrcline(&sf->lines[nline-1],name,nline);
+	}
+	sf->busy=0;
+	includenest--;
+	if(!includenest) {//if main source file (not included)
+		errmsg=0;
+		if(iflevel)
+			errmsg=NoENDIF;
+		if(reptcount)
+			errmsg=NoENDR;
+		if(makemacro)
+			errmsg=NoENDM;
+		if(nooutput)
+			errmsg=NoENDE;
+		// [freem addition]
+		if(nonl)
+			errmsg=NoENDINL;
+		if(errmsg)
+			showerror(name,nline);
+	}
+}
+
+//process single line of text that isn't worth lexing
+void processline(char *src,char *errsrc,int errline) {
+	srcline sl;
+	sl.text=src;
+	sl.lexed=-1;
+	sl.memo=0;
+	processsrcline(&sl,errsrc,errline);
+}
+
+#define MEMODEPS 16
+#define MEMOBYTES 64
+#define MEMOTEXT 256
+
+//line memo being recorded
+memodep memodeps[MEMODEPS];
+int memodepcount;
+byte memobuff[MEMOBYTES];
+int memobytecount;
+int memocdl;
+char memotext[MEMOTEXT+LINEMAX];
+int memotextlen;
+
+//state outside the symbol table that changes how a line assembles
+static int memoflags(void) {
+	return (allowunstable!=0) | (allowhunstable!=0)<<1 | (rsvdshadowed!=0)<<2;
+}
+
+static void memo_start(void) {
+	//dependant is only cleared by the directives that use it, and eval() skips
+	//operators while it's set, so one left over from an earlier line would get
+	//its garbage recorded. start clean, and don't keep a line that saw it set
+	memorec=1;
+	memook=!dependant;
+	dependant=0;
+	memoaddr=0;
+	memodepcount=memobytecount=memotextlen=0;
+}
+
+//findlabel(name) returned p
+void memo_dep(char *name,label *p) {
+	memodep *d;
+	int i,len;
+	if(!memook)
+		return;
+	for(i=0;i<memodepcount;i++)//(opcode() evaluates the operand once per addressing mode)
+		if(!strcmp(memotext+memodeps[i].name,name))
+			return;
+	len=strlen(name)+1;
+	if(memodepcount==MEMODEPS || memotextlen+len>MEMOTEXT) {
+		memook=0;
+		return;
+	}
+	d=&memodeps[memodepcount++];
+	d->p=p;
+	if(p) {
+		d->value=(*p).value;
+		d->line=(*p).line;
+		d->type=(*p).type;
+		d->current=(*p).pass==pass;
+	}
+	d->name=memotextlen;
+	memcpy(memotext+memotextlen,name,len);
+	memotextlen+=len;
+}
+
+//output(p,size,cdlflag) was called
+void memo_bytes(byte *p,int size,int cdlflag) {
+	if(!memook)
+		return;
+	if(!memobytecount)
+		memocdl=cdlflag;
+	if(cdlflag!=memocdl || memobytecount+size>MEMOBYTES) {
+		memook=0;
+		return;
+	}
+	memcpy(memobuff+memobytecount,p,size);
+	memobytecount+=size;
+}
+
+//can a line using this directive be memoized?
+static int memo_directive(label *p) {
+	icfn fn=(icfn)(*p).value;
+	return (*p).type==RESERVED && (fn==opcode || fn==db || fn==dw || fn==dl || fn==dh || fn==hex);
+}
+
+//keep what was recorded for sl. listtext=expanded line for the listing, or NULL
+static void memo_save(srcline *sl,char *listtext) {
+	linememo *m=sl->memo;
+	int size,textlen=memotextlen;
+	if(listtext) {
+		strcpy(memotext+textlen,listtext);
+		textlen+=strlen(listtext)+1;
+	}
+	size=sizeof(linememo)+memodepcount*sizeof(memodep)+memobytecount+textlen;
+	if(!m || m->size<size) {
+		m=(linememo*)arena_alloc(&asmarena,size,MEM_MEMO);
+		m->size=size;
+		sl->memo=m;
+	}
+	m->valid=1;
+	m->pc=memoaddr ? addr-memobytecount : -1;
+	m->flags=memoflags();
+	m->cdlflag=memocdl;
+	m->ndeps=memodepcount;
+	m->nbytes=memobytecount;
+	m->listtext=listtext ? memotextlen : -1;
+	m->deps=(memodep*)(m+1);
+	m->bytes=(byte*)(m->deps+memodepcount);
+	m->text=(char*)(m->bytes+memobytecount);
+	memcpy(m->deps,memodeps,memodepcount*sizeof(memodep));
+	memcpy(m->bytes,memobuff,memobytecount);
+	memcpy(m->text,memotext,textlen);
+}
+
+//output sl again if nothing it depends on has changed since it was memoized
+static int memo_replay(srcline *sl,char *errsrc,int errline) {
+	linememo *m=sl->memo;
+	memodep *d;
 	label *p;
+	int i;
+	if(!m->valid || insidemacro || makemacro || reptcount || skipline[iflevel] || nooutput)
+		return 0;
+	if(addr<0 || addr>0xffff || (m->pc>=0 && m->pc!=addr) || m->flags!=memoflags())
+		return 0;
+	for(i=0;i<m->ndeps;i++) {
+		d=&m->deps[i];
+		p=lookuplabel(m->text+d->name);
+		if(p!=d->p)
+			return 0;
+		if(p && ((*p).value!=d->value || (*p).line!=d->line || (*p).type!=d->type || ((*p).pass==pass)!=d->current))
+			return 0;
+	}
+	if(m->listtext>=0)
+		listline(m->text+m->listtext,sl->comment>=0 ? sl->text+sl->comment : 0);
+	errmsg=0;
+	output(m->bytes,m->nbytes,m->cdlflag);
+	if(errmsg)
+		showerror(errsrc,errline);
+	memohits++;
+	return 1;
+}
 
+//process single line
+//sl=source line (lexed here if it hasn't been yet)
+//errsrc=source file name
+//errline=source file line number
+void processsrcline(srcline *sl,char *errsrc,int errline) {
+	char line[LINEMAX];//expanded line
+	char word[WORDMAX];
+	char *s,*s2,*comment;
+	char *endmac;
+	label *p;
+	rsvdhints hints,*oldhints;
+	char *olddbgsrc=dbgsrc;
+	int olddbgline=dbgline,olddbgseq=dbgseq;
+	int memoing,oldneed=0;
+	char listcopy[LINEMAX];
+	int profiled=profiling && !insidemacro;//(lines inside macros count towards the macro)
+	double t0=0;
+	int b0=0;
+
+	if(profiled) {
+		t0=prof_now();
+		b0=profbytes;
+	}
 	errmsg=0;
-	comment=expandline(line,src);
+	dbgsrc=errsrc;
+	dbgline=errline;
+	dbgseq=++dbglines;
+	if(!insidemacro) {
+		dbgfile=errsrc;
+		dbgfileline=errline;
+	}
+	if(!sl->lexed)
+		lexline(sl,&asmarena,MEM_SOURCE);
+	if(sl->memo && memo_replay(sl,errsrc,errline))
+		goto done;
+	memoing=sl->lexed>0 && !insidemacro && !makemacro && !reptcount && !skipline[iflevel] && !nooutput;
+	if(memoing) {
+		memo_start();
+		oldneed=needanotherpass;
+		needanotherpass=0;
+	}
+	oldhints=curhints;
+	if(sl->lexed>0) {
+		comment=expandlexed(line,sl,&hints);
+		curhints=&hints;
+	} else {
+		comment=expandline(line,sl->text);
+		curhints=0;
+	}
 	if(!insidemacro || verboselisting)
 		listline(line,comment);
+	if(memoing && listfilename)
+		strcpy(listcopy,line);
 
 	s=line;
 	if(errmsg) {	//expandline error?
@@ -1764,7 +3688,7 @@ void processline(char *src,char *errsrc,int errline) {
 			if(makemacro&&makemacro!=true_ptr) {
 				if(comment)
 					strcat(line,comment);	   //keep comment for listing
-				*makemacro=my_malloc(strlen(line)+sizeof(char*)+1);
+				*makemacro=(char*)arena_alloc(&asmarena,strlen(line)+sizeof(char*)+1,MEM_MACROS);
 				makemacro=(char**)*makemacro;
 				*makemacro=0;
 				strcpy((char*)&makemacro[1],line);
@@ -1796,7 +3720,7 @@ void processline(char *src,char *errsrc,int errline) {
 			if(reptcount || endmac) {   //add this line to REPT body
 				if(comment)
 					strcat(line,comment);	   //keep comment for listing
-				*makerept=my_malloc(strlen(line)+sizeof(char*)+1);
+				*makerept=(char*)arena_alloc(&reptarena,strlen(line)+sizeof(char*)+1,MEM_REPT);
 				makerept=(char**)*makerept;
 				*makerept=0;
 				strcpy((char*)&makerept[1],line);
@@ -1820,17 +3744,22 @@ void processline(char *src,char *errsrc,int errline) {
 				break;
 		}
 		if(!p) {//maybe a label?
+			memorec=0;
 			if(getlabel(word,&s2)) addlabel(word,insidemacro);
 			if(errmsg) goto badlabel;//fucked up label
 			p=getreserved(&s);
 		}
 		if(p) {
+			if(memorec && !memo_directive(p))
+				memorec=0;
 			if((*p).type==MACRO)
 				expandmacro(p,&s,errline,errsrc);
 			else
 				// call assembler function for the given directive.
 				((icfn)(*p).value)(p,&s);
 		}
+		if(pchrec)
+			pch_line(p);
 		if(!errmsg) {//check extra garbage
 			s+=strspn(s,whitesp);
 			if(*s)
@@ -1841,12 +3770,28 @@ badlabel:
 			showerror(errsrc,errline);
 		}
 	} while(0);
+	if(memoing) {
+		if(memorec && memook && !dependant && !errmsg && !needanotherpass)
+			memo_save(sl,listfilename ? listcopy : 0);
+		else if(sl->memo)
+			sl->memo->valid=0;
+		memorec=0;
+		needanotherpass|=oldneed;
+	}
+	curhints=oldhints;
+done:
+	dbgsrc=olddbgsrc;
+	dbgline=olddbgline;
+	dbgseq=olddbgseq;
+	if(profiled)
+		prof_end(PROF_LINE,errsrc,errline,t0,b0);
 }
 
 void showhelp(void) {
 	puts("");
 	puts("asm6f " VERSION " (+ freem modifications)\n");
-	puts("Usage:  asm6f [-options] sourcefile [outputfile] [listfile]\n");
+	puts("Usage:  asm6f [-options] sourcefile [outputfile] [listfile]");
+	puts("        asm6f [-options] --batch file\n");
 	puts("\t-?\t\tshow this help");
 	puts("\t-l\t\tcreate listing");
 	puts("\t-L\t\tcreate verbose listing (expand REPT, MACRO)");
@@ -1856,35 +3801,341 @@ void showhelp(void) {
 	puts("\t-n\t\texport FCEUX-compatible .nl files");
 	puts("\t-f\t\texport Lua symbol file");
 	puts("\t-c\t\texport .cdl for use with FCEUX/Mesen");
-	puts("\t-m\t\texport Mesen-compatible label file (.mlb)\n");
+	puts("\t-m\t\texport Mesen-compatible label file (.mlb)");
+	puts("\t-g\t\texport line/address debug database (.dbg)");
+	puts("\t-G\t\texport debug database as JSON (.dbg.json)\n");
 	puts("\t-i\t\tbuild .ips format patch file instead of binary.");
+	puts("\t-b\t\talso build .bps patch against the INCNES rom");
+	puts("\t-u\t\talso build .ups patch against the INCNES rom");
+	puts("\t--mem-stats\tshow memory usage when done");
+	puts("\t--profile\ttime the assembly per line/macro (.prof, .trace.json)");
+	puts("\t--pass-report\tshow why each pass was needed");
+	puts("\t--watch\t\tassemble again whenever a source file changes");
+	puts("\t--batch <file>\tassemble each job (one command line per line) in file");
+	puts("\t-j<n>\t\tsplit the --batch jobs between n processes (POSIX only)");
+	puts("\t--config <name>[=<sym>,..]  build once per --config, defining its symbols");
+	puts("\t--pch <dir>\tkeep snapshots of INCLUDEd definition files in dir");
+	puts("\t--cache <dir>\tcopy outputs from dir when no input or option changed");
 	puts("See README.TXT for more info.\n");
 }
 
 //--------------------------------------------------------------------------------------------
 
-int main(int argc,char **argv) {
-	int i,notoption;
-	char* tryname;
+//assemble the source file and write all the outputs.
+//returns EXIT_FAILURE if there were errors.
+int assemble(void) {
+	char *tryname;
 	label *p;
-	FILE *f;
+	double t0=0;
+	int b0=0;
 
-	if(argc<2) {
-		showhelp();
-		return EXIT_FAILURE;
+	//main assembly loop:
+	p=0;
+	do {
+		filepos=0;
+		filesize=0;
+		pass++;
+		if(pass==MAXPASSES || (p==lastlabel))
+			lastchance=1;//give up on too many tries or no progress made
+		if(lastchance)
+			message("last try..\n");
+		else
+			message("pass %i..\n",pass);
+		needanotherpass=0;
+		skipline[0]=0;
+		scope=1;		
+		nextscope=2;
+		arena_reset(&passarena);	//drop last pass's comments and IPS hunks
+		arena_reset(&reptarena);
+		commentcount=0;
+		lastcommentpos=-1;
+		ips_hunkcount=0;
+		dbg_reset();
+		defaultfiller=DEFAULTFILLER;	//reset filler value
+		addr=NOORIGIN;//undefine origin
+		p=lastlabel;
+		tryname=inputfilename;
+		if(profiling || passreport) {
+			t0=prof_now();
+			b0=profbytes;
+		}
+		include(0,&tryname);		//start assembling srcfile
+		if(profiling)
+			prof_end(PROF_PASS,"pass",pass,t0,b0);
+		if(passreport)
+			pass_report(prof_now()-t0);
+		if(errmsg)
+		{
+			//todo - shouldn't this set error?
+			diagnostic("%s",errmsg);//bad inputfile??
+		}
+	} while(!error && !lastchance && needanotherpass);//while no hard errors, not final try, and labels are still unresolved
+	
+	if((genbps || genups) && !baseromname && !error)
+		fatal_error(NoBaseROM);
+	
+	if(outputstarted) {
+		// Be sure last of output is collected
+		flush_output(1);
+		
+		if(!error && outputfilename) {
+			// the whole image is written in one go, only once it's known to be good
+			FILE *outputfile=openoutput(outputfilename,"wb");
+			if(!outputfile)
+				fatal_error(CantCreateFile);
+			if(fwrite(romimage,1,filesize,outputfile)<(size_t)filesize) {
+				fclose(outputfile);
+				fatal_error(CantWrite);
+			}
+			if(fclose(outputfile))
+				fatal_error(CantWrite);
+			message("%s written (%i bytes).\n",outputfilename,filesize);
+			
+			if(gencdl)
+				write_cdl();
+			if(genbps || genups)
+				write_deltapatches();
+		} else if(error && outputfilename)
+			remove(outputfilename);
+	} else if (!genips) {
+		if(!error)
+			diagnostic("nothing to do!\n");
+		error = 1;
 	}
-	initlabels();
-	initcomments();
-	notoption=0;
-	for(i=1;i<argc;i++) {
+	
+	if (genips)
+	{
+		puts(ipsfilename);
+		FILE* ipsfile = openoutput(ipsfilename, "wb");
+		if (!ipsfile)
+		{
+			errmsg = CantWrite;
+		}
+		else
+		{
+			ips_write(ipsfile);
+			fclose(ipsfile);
+		}
+	} 
+	
+	if(listfilename)
+		listline(0,0);
+
+	// [freem addition] only generate labelfiles if asked
+	if(genfceuxnl)
+		export_labelfiles();
+	if(genlua)
+		export_lua();
+	if(genmesenlabels)
+		export_mesenlabels();
+	if(gendbg)
+		export_dbg();
+	if(profiling)
+		export_profile();
+
+	return error ? EXIT_FAILURE : 0;
+}
+
+//assemble(), or copy the outputs back from --cache if nothing they depend on changed
+int build(void) {
+	unsigned long long key;
+	int status;
+
+	if(!cachedir || watching || profiling || passreport)//(timings can't come from a cache)
+		return assemble();
+	key=cache_optionkey();
+	if(cache_restore(key))
+		return 0;
+	cache_clear();
+	cacherec=1;
+	status=assemble();
+	cacherec=0;
+	if(!status)
+		cache_store(key);
+	cache_clear();
+	return status;
+}
+
+//set everything back to how it was before the first assemble(), apart from the
+//file caches, so --watch can build again
+void reset_assembler(void) {
+	sourcefile *sf;
+	int i;
+
+	restore_symbols();
+	for(sf=sourcefiles;sf;sf=sf->next) {//(memos point to labels that are gone now)
+		sf->busy=0;
+		for(i=0;i<sf->linecount;i++)
+			sf->lines[i].memo=0;
+	}
+	pass=0;
+	lastchance=0;
+	needanotherpass=0;
+	error=0;
+	errmsg=0;
+	makemacro=0;
+	reptcount=0;
+	iflevel=0;
+	memset(ifdone,0,sizeof(ifdone));
+	memset(skipline,0,sizeof(skipline));
+	insidemacro=0;
+	includenest=0;
+	curframe=0;
+	curhints=0;
+	labelhere=0;
+	nooutput=0;
+	nonl=0;
+	comparefiller=0;
+	allowunstable=allowhunstable=0;
+	ines_include=inesprg_num=ineschr_num=inesmir_num=inesmap_num=0;
+	use_nes2=nes2chr_num=nes2prg_num=nes2sub_num=nes2tv_num=nes2vs_num=0;
+	nes2wram_num=nes2bram_num=nes2chrbram_num=0;
+	memset(ines_extension,0,sizeof(ines_extension));
+	memset(ines_extension_mask,0,sizeof(ines_extension_mask));
+	baseromname=0;
+	outputstarted=0;
+	outputpass=listpass=0;
+	listerr=0;
+	memorec=memohits=0;
+	pchrec=0;
+	cache_clear();
+	passnotecount=0;
+	prof_reset();
+}
+
+//define a symbol as 1 (-d), unless it's already there
+void define_symbol(char *name) {
+	label *p;
+	if(!findlabel(name)) {
+		p=newlabel(0);
+		(*p).type=VALUE;
+		(*p).value=1;
+		(*p).line=true_ptr;
+		(*p).pass=0;
+	}
+}
+
+int asm6f_assemble(const asm6f_options *options,asm6f_result *result) {
+	static const char busymsg[]="asm6f_assemble() called while an assembly is running.\n";
+	static int started=0;
+	static int running=0;
+	static int lastused=0;
+	static char *source=0;
+	jmp_buf jump,*oldjump=fataljump;
+	label **list;
+	asm6f_symbol *sym;
+	char *names;
+	size_t namesize;
+	int i,n;
+
+	memset(result,0,sizeof(*result));
+	if(running) {//(from a read callback; everything it would use is in use)
+		result->symbols=(asm6f_symbol*)my_malloc(1);
+		result->diagnostics=strcpy(my_malloc(sizeof(busymsg)),busymsg);
+		result->errors=1;
+		return -1;
+	}
+	running=1;
+	verbose=0;
+	listfilename=outputfilename=0;
+	genfceuxnl=genmesenlabels=gendbg=gencdl=genlua=genips=genbps=genups=0;
+	profiling=passreport=showmemstats=0;
+	pchdir=cachedir=0;
+	diagcapture=1;
+	diaglen=0;
+	if(!started) {
+		initlabels();
+		initcomments();
+		save_symbols();
+		started=1;
+	} else
+		reset_assembler();
+	//files that came from memory may be different this time, and the disk files
+	//they were standing in for must not be mixed up with them
+	libfilesused=0;
+	drop_changed_files(lastused || (options->files && options->filecount) || options->read);
+	libfiles=options;
+
+	fataljump=&jump;
+	if(!setjmp(jump)) {
+		free(source);//(include() trims the name in place, so it needs a copy)
+		source=my_malloc(strlen(options->source)+1);
+		inputfilename=strcpy(source,options->source);
+		for(i=0;options->defines && options->defines[i];i++)
+			define_symbol((char*)options->defines[i]);
+		assemble();
+	} else
+		error=1;
+	fataljump=oldjump;
+	libfiles=0;
+	lastused=libfilesused;
+
+	result->errors=error;
+	if(!error && outputstarted) {
+		result->rom=(unsigned char*)my_malloc(filesize ? filesize : 1);
+		memcpy(result->rom,romimage,filesize);
+		result->romsize=filesize;
+	}
+
+	list=allsymbols(&n);
+	qsort(list,n,sizeof(label*),comparelabelnames);
+	namesize=0;
+	for(i=0;i<n;i++) {
+		namesize+=strlen(list[i]->name)+1;
+		if(list[i]->type==EQUATE)
+			namesize+=strlen(list[i]->line)+1;
+	}
+	//(the names live in the same block, after the symbols)
+	result->symbols=sym=(asm6f_symbol*)my_malloc(n*sizeof(asm6f_symbol)+namesize+1);
+	names=(char*)(sym+n);
+	for(i=0;i<n;i++,sym++) {
+		label *l=list[i];
+		sym->name=strcpy(names,l->name);
+		names+=strlen(names)+1;
+		sym->type=l->type==LABEL ? ASM6F_LABEL : l->type==VALUE ? ASM6F_VALUE : ASM6F_EQUATE;
+		sym->value=l->type==EQUATE ? 0 : l->value;
+		sym->offset=l->type==LABEL ? l->pos : -1;
+		sym->scope=l->scope;
+		sym->text=0;
+		if(l->type==EQUATE) {
+			sym->text=strcpy(names,l->line);
+			names+=strlen(names)+1;
+		}
+	}
+	result->symbolcount=n;
+	free(list);
+
+	result->diagnostics=my_malloc(diaglen+1);
+	memcpy(result->diagnostics,diagbuf ? diagbuf : "",diaglen);
+	result->diagnostics[diaglen]=0;
+	diagcapture=0;
+	running=0;
+	return error ? -1 : 0;
+}
+
+void asm6f_free(asm6f_result *result) {
+	free(result->rom);
+	free(result->symbols);
+	free(result->diagnostics);
+	memset(result,0,sizeof(*result));
+}
+
+#ifndef ASM6F_NO_MAIN
+//read command line arguments (or a --batch job's) into the option globals.
+//job is set for a --batch job, which can't use the options that run several builds.
+//returns 0 if help was asked for.
+int parse_options(int argc,char **argv,int job) {
+	int i,notoption=0;
+
+	for(i=0;i<argc;i++) {
 		if(*argv[i]=='-' || (*argv[i]=='/' && strlen(argv[i]) == 2)) {
 			switch(argv[i][1]) {
 				case 'h':
 				case '?':
-					showhelp();
-					return EXIT_FAILURE;
+					return 0;
 				case 'L':
 					verboselisting=1;
+					//fallthrough
 				case 'l':
 					listfilename=true_ptr;
 					break;
@@ -1908,14 +4159,7 @@ int main(int argc,char **argv) {
 						}
 						*/
 
-						if(!findlabel(&argv[i][2])) {
-							p=newlabel();
-							(*p).name=my_strdup(&argv[i][2]);
-							(*p).type=VALUE;
-							(*p).value=1;
-							(*p).line=true_ptr;
-							(*p).pass=0;
-						}
+						define_symbol(&argv[i][2]);
 					}
 					break;
 				case 'q':
@@ -1931,12 +4175,69 @@ int main(int argc,char **argv) {
 				case 'c':
 					gencdl = 1;
 					break;
+				case 'g':
+					gendbg=1;
+					break;
+				case 'G':
+					gendbg=2;
+					break;
 				case 'f':
 					genlua=1;
 					break;
 				case 'i':
 					genips=1;
 					break;
+				case 'b':
+					genbps=1;
+					break;
+				case 'u':
+					genups=1;
+					break;
+				case 'j':
+					if(job || (batchjobs=atoi(argv[i]+2))<1)
+						fatal_error("unknown option: %s",argv[i]);
+					break;
+				case '-':
+					if(!strcmp(argv[i]+2,"mem-stats")) {
+						showmemstats=1;
+						break;
+					}
+					if(!strcmp(argv[i]+2,"profile")) {
+						profiling=1;
+						break;
+					}
+					if(!strcmp(argv[i]+2,"pass-report")) {
+						passreport=1;
+						break;
+					}
+					if(!job && !strcmp(argv[i]+2,"watch")) {
+						watching=1;
+						break;
+					}
+					if(!job && !strcmp(argv[i]+2,"batch") && i+1<argc) {
+						batchfilename=argv[++i];
+						break;
+					}
+					if(!job && !strcmp(argv[i]+2,"cache") && i+1<argc) {
+						cachedir=argv[++i];
+						if(strlen(cachedir)+32>LINEMAX+64)//(room for /<hash>.inputs)
+							fatal_error("directory name too long: %s",cachedir);
+						break;
+					}
+					if(!job && !strcmp(argv[i]+2,"pch") && i+1<argc) {
+						pchdir=argv[++i];
+						if(strlen(pchdir)+22>LINEMAX)//(room for /<hash>.pch)
+							fatal_error("directory name too long: %s",pchdir);
+						break;
+					}
+					if(!job && !strcmp(argv[i]+2,"config") && i+1<argc) {
+						if(configcount==MAXCONFIGS)
+							fatal_error("too many configurations");
+						configs[configcount++]=argv[++i];
+						break;
+					}
+					fatal_error("unknown option: %s",argv[i]);
+					break;
 				default:
 					fatal_error("unknown option: %s",argv[i]);
 			}
@@ -1952,6 +4253,14 @@ int main(int argc,char **argv) {
 			notoption++;
 		}
 	}
+	return 1;
+}
+
+//work out the names of the files to write from the source name and options
+void set_filenames(void) {
+	char* tryname;
+	FILE *f;
+
 	if(!inputfilename) 
 		fatal_error("No source file specified.");
 	
@@ -1983,83 +4292,248 @@ int main(int argc,char **argv) {
 	if(gencdl) {
 		cdlfilename = replace_ext(inputfilename, ".cdl");
 	}
+	if(genbps)
+		bpsfilename = replace_ext(outputfilename, ".bps");
+	if(genups)
+		upsfilename = replace_ext(outputfilename, ".ups");
+}
 
-	//main assembly loop:
-	p=0;
-	do {
-		filepos=0;
-		filesize=0;
-		pass++;
-		if(pass==MAXPASSES || (p==lastlabel))
-			lastchance=1;//give up on too many tries or no progress made
-		if(lastchance)
-			message("last try..\n");
-		else
-			message("pass %i..\n",pass);
-		needanotherpass=0;
-		skipline[0]=0;
-		scope=1;		
-		nextscope=2;
-		defaultfiller=DEFAULTFILLER;	//reset filler value
-		addr=NOORIGIN;//undefine origin
-		p=lastlabel;
-		tryname=inputfilename;
-		include(0,&tryname);		//start assembling srcfile
-		if(errmsg)
-		{
-			//todo - shouldn't this set error?
-			fputs(errmsg, stderr);//bad inputfile??
+//options a --batch job starts with (the ones given on the command line)
+int *batchoptions[]={&verboselisting,&verbose,&genfceuxnl,&genmesenlabels,&gendbg,&gencdl,&genlua,
+	&genips,&genbps,&genups,&profiling,&passreport};
+#define BATCHOPTIONS (int)(sizeof(batchoptions)/sizeof(batchoptions[0]))
+#define BATCHARGS 64
+
+//run one line of the --batch manifest. returns 0 if it built (or is blank).
+int batch_job(char *line,int n,int *defaults,char *listdefault) {
+	char *argv[BATCHARGS];
+	volatile int argc=0;//(volatile: it has to survive the longjmp from a fatal error)
+	int i;
+	jmp_buf jump;
+	char *s=line;
+
+	//split into arguments at whitespace, "quotes" keep spaces
+	for(;;) {
+		s+=strspn(s,whitesp2);
+		if(!*s || *s==';' || *s=='#')
+			break;
+		if(argc==BATCHARGS) {
+			diagnostic("%s(%i): Too many arguments.\n",batchfilename,n);
+			return 1;
 		}
-	} while(!error && !lastchance && needanotherpass);//while no hard errors, not final try, and labels are still unresolved
-	
-	if(outputfile) {
-		// Be sure last of output file is written properly
-		int result;
-		flush_output(1);
-		
-		result = fclose(outputfile);
-		outputfile = NULL; // prevent fatal_error() from trying to close file again
-		if ( result )
-			fatal_error( CantWrite);
-		
-		if(!error) {
-			message("%s written (%i bytes).\n",outputfilename,filesize);
-		} else
-			remove(outputfilename);
-	} else if (!genips) {
-		if(!error)
-			fputs("nothing to do!", stderr);
-		error = 1;
+		if(*s=='"') {
+			argv[argc++]=++s;
+			s+=strcspn(s,"\"");
+		} else {
+			argv[argc++]=s;
+			s+=strcspn(s,whitesp2);
+		}
+		if(*s)
+			*s++=0;
 	}
-	
-	if (genips)
-	{
-		puts(ipsfilename);
-		FILE* ipsfile = fopen(ipsfilename, "wb");
-		if (!ipsfile)
-		{
-			errmsg = CantWrite;
+	if(!argc)
+		return 0;
+
+	reset_assembler();
+	drop_changed_files(0);//(an earlier job may have written a file this one reads)
+	for(i=0;i<BATCHOPTIONS;i++)
+		*batchoptions[i]=defaults[i];
+	listfilename=listdefault;
+	inputfilename=outputfilename=ipsfilename=cdlfilename=bpsfilename=upsfilename=0;
+	fataljump=&jump;//(a fatal error only ends that job)
+	if(setjmp(jump))
+		error=1;
+	else {
+		if(!parse_options(argc,argv,1))
+			fatal_error("unknown option: -?");
+		set_filenames();
+		build();
+	}
+	fataljump=0;
+	if(error)
+		diagnostic("%s(%i): job failed.\n",batchfilename,n);
+	return error!=0;
+}
+
+//assemble every job in the --batch manifest. jobs in the same process share the
+//file cache; with -j they are split between that many processes (fork(), so POSIX
+//only; elsewhere -j is ignored).
+int run_batch(void) {
+	int defaults[BATCHOPTIONS];
+	char *listdefault=listfilename;
+	char *text,*line,*next,*s;
+	long size;
+	time_t mtime;
+	int i,n,lines,worker=0;
+	volatile int failed=0;
+
+	if(inputfilename)
+		fatal_error("unused argument: %s",inputfilename);
+	if(!(text=readfile(batchfilename,&size,&mtime)))
+		fatal_error("Can't open %s.",batchfilename);
+	text[size]=0;
+	for(i=0;i<BATCHOPTIONS;i++)
+		defaults[i]=*batchoptions[i];
+	save_symbols();//(with the command line's -d symbols)
+
+#ifdef HAVE_FORK
+	if(batchjobs>1) {
+		int status;
+		fflush(stdout);
+		fflush(stderr);
+		for(worker=0;worker<batchjobs;worker++)
+			if(fork()==0)
+				break;
+		if(worker==batchjobs) {//(this is the parent, the workers do the jobs)
+			while(wait(&status)>0)
+				if(!WIFEXITED(status) || WEXITSTATUS(status))
+					failed=1;
+			free(text);
+			return failed ? EXIT_FAILURE : 0;
 		}
-		else
-		{
-			ips_write(ipsfile);
-			fclose(ipsfile);
+	}
+#else
+	if(batchjobs>1)
+		message("-j needs fork(), the jobs will run one after another.\n");
+	batchjobs=1;
+#endif
+	if(batchjobs<1)
+		batchjobs=1;
+	n=lines=0;
+	for(line=text;*line;line=next) {
+		next=line+strcspn(line,"\r\n");
+		if(*next)
+			*next++=0;
+		lines++;
+		s=line+strspn(line,whitesp2);
+		if(*s && *s!=';' && *s!='#' && n++%batchjobs==worker)
+			failed+=batch_job(line,lines,defaults,listdefault);
+	}
+	if(worker==0 && !n)
+		message("%s: no jobs.\n",batchfilename);
+	free(text);
+#ifdef HAVE_FORK
+	if(batchjobs>1)
+		exit(failed ? EXIT_FAILURE : 0);
+#endif
+	return failed ? EXIT_FAILURE : 0;
+}
+
+//output file names, and what they were before run_configs() named them for a configuration
+char **outputnames[]={&outputfilename,&listfilename,&ipsfilename,&cdlfilename,&bpsfilename,&upsfilename};
+#define OUTPUTNAMES (int)(sizeof(outputnames)/sizeof(outputnames[0]))
+char *basenames[OUTPUTNAMES];
+
+//assemble the source once per --config. they share the file cache (so every source
+//is only read and lexed once), everything else is done again for each one.
+//the outputs get the configuration's name: game.bin -> game.ntsc.bin
+//the symbol table must have been saved (save_symbols) before.
+int run_configs(void) {
+	jmp_buf jump,*oldjump=fataljump;
+	char name[LINEMAX],symbols[LINEMAX];
+	char *sym,*next;
+	int i,j;
+	volatile int failed=0;//(volatile: it has to survive the longjmp from a fatal error)
+
+	if(!basenames[0])
+		for(j=0;j<OUTPUTNAMES;j++)
+			basenames[j]=*outputnames[j];
+	for(i=0;i<configcount;i++) {
+		if(i)
+			reset_assembler();
+		fataljump=&jump;//(a fatal error only ends that configuration)
+		if(setjmp(jump))
+			error=1;
+		else {
+			if(strlen(configs[i])>=LINEMAX)
+				fatal_error("configuration too long: %s",configs[i]);
+			strcpy(name,configs[i]);
+			sym=strchr(name,'=');
+			if(sym)
+				*sym++=0;
+			strcpy(symbols,sym ? sym : name);//(just a name defines that name)
+			for(sym=symbols;*sym;sym=next) {
+				next=sym+strcspn(sym,",");
+				if(*next)
+					*next++=0;
+				if(*sym)
+					define_symbol(sym);
+			}
+			for(j=0;j<OUTPUTNAMES;j++) {
+				if(*outputnames[j]!=basenames[j])
+					free(*outputnames[j]);//(the last configuration's)
+				*outputnames[j]=basenames[j] ? insert_ext(basenames[j],name) : 0;
+			}
+			build();
+		}
+		if(error) {
+			diagnostic("configuration %s failed.\n",configs[i]);
+			failed=1;
+		}
+	}
+	fataljump=oldjump;
+	return failed ? EXIT_FAILURE : 0;
+}
+
+int main(int argc,char **argv) {
+	int status;
+
+	if(argc<2) {
+		showhelp();
+		return EXIT_FAILURE;
+	}
+	initlabels();
+	initcomments();
+	if(!parse_options(argc-1,argv+1,0)) {
+		showhelp();
+		return EXIT_FAILURE;
+	}
+	if(batchfilename) {
+		if(configcount)
+			fatal_error("--config can't be used with --batch.");
+		status=run_batch();
+		if(showmemstats)
+			show_memstats();
+		return status;
+	}
+	set_filenames();
+
+	if(watching) {//build, then build again whenever a file changes
+		jmp_buf jump;
+		double start;
+		save_symbols();
+		fataljump=&jump;//(a fatal error only ends that build)
+		for(;;) {
+			start=prof_now();
+			if(!setjmp(jump)) {
+				if(configcount)
+					run_configs();
+				else
+					assemble();
+				printf("built in %.0f ms.\n",(prof_now()-start)*1000);
+			}
+			if(!watch_files())
+				break;
+			reset_assembler();
 		}
-	} 
+		fataljump=0;
+		fatal_error("Nothing to watch.");
+	}
+	if(configcount) {
+		save_symbols();
+		status=run_configs();
+	} else
+		status=build();
 	
-	if(listfile)
-		listline(0,0);
-
-	// [freem addition] only generate labelfiles if asked
-	if(genfceuxnl)
-		export_labelfiles();
-	if(genlua)
-		export_lua();
-	if(genmesenlabels)
-		export_mesenlabels();
+	if(showmemstats)
+		show_memstats();
+	arena_free(&passarena);
+	arena_free(&reptarena);
+	arena_free(&asmarena);
 
-	return error ? EXIT_FAILURE : 0;
+	return status;
 }
+#endif
 
 // returns position of extension in the path, or
 // end of string if no extension.
@@ -2097,52 +4571,134 @@ char* replace_ext(char* in, char* ext)
 	return out;
 }
 
+// duplicates the given filename with "." and name
+// inserted before its extension (game.bin -> game.name.bin)
+char* insert_ext(char* in, char* name)
+{
+	char* ext = find_ext(in);
+	char* out = my_malloc(strlen(in) + strlen(name) + 2);
+	
+	memcpy(out, in, ext - in);
+	sprintf(out + (ext - in), ".%s%s", name, ext);
+	
+	return out;
+}
+
 #define LISTMAX 8//number of output bytes to show in listing
 byte listbuff[LISTMAX];
 int listcount;
 
-ips_hunk* malloc_ips_hunk_regular(size_t offset, byte* p, size_t count)
+// adds a hunk holding a copy of `count` bytes from `p`.
+void ips_add_regular(int offset, byte* p, int count)
 {
+	ips_hunk hunk;
+	
 	assert(count > 0);
 	
-	ips_hunk* hunk = (ips_hunk*)my_malloc(sizeof(ips_hunk));
-	hunk->offset = offset;
-	hunk->length = count;
-	hunk->contents = (byte*)my_malloc(count);
-	hunk->suppress = 0;
-	hunk->next = 0;
-	memcpy(hunk->contents, p, count);
-	return hunk;
+	hunk.offset = offset;
+	hunk.length = count;
+	hunk.contents = (byte*)arena_alloc(&passarena, count, MEM_IPS);
+	hunk.rle_content = 0;
+	hunk.suppress = 0;
+	memcpy(hunk.contents, p, count);
+	ips_add_hunk(&hunk);
 }
 
-ips_hunk* malloc_ips_hunk_rle(size_t offset, byte b, size_t count)
+// adds a hunk holding `count` copies of `b`.
+void ips_add_rle(int offset, byte b, int count)
 {
+	ips_hunk hunk;
+	
 	assert(count > 0);
 	
-	ips_hunk* hunk = (ips_hunk*)my_malloc(sizeof(ips_hunk));
-	hunk->offset = offset;
-	hunk->length = count;
-	hunk->contents = 0;
-	hunk->rle_content = b;
-	hunk->suppress = 0;
-	hunk->next = 0;
-	return hunk;
+	hunk.offset = offset;
+	hunk.length = count;
+	hunk.contents = 0;
+	hunk.rle_content = b;
+	hunk.suppress = 0;
+	ips_add_hunk(&hunk);
+}
+
+// returns the index of the first hunk that ends after `offset`.
+int ips_find_hunk(int offset)
+{
+	int lo = 0, hi = ips_hunkcount;
+	while (lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+		if (ips_hunks[mid].offset + ips_hunks[mid].length <= offset)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+// true if `next` can be folded into `hunk`, which ends where `next` starts.
+static int ips_can_merge(ips_hunk* hunk, ips_hunk* next)
+{
+	if (hunk->suppress != next->suppress)
+		return 0;
+	if (hunk->contents)
+		return next->contents == hunk->contents + hunk->length;
+	return !next->contents && next->rle_content == hunk->rle_content;
 }
 
-void ips_append_hunk(ips_hunk* hunk)
+// inserts a copy of `hunk` into the hunk list, overwriting whatever
+// older hunks it overlaps. (later hunks always win.)
+void ips_add_hunk(ips_hunk* hunk)
 {
-	hunk->next = 0;
+	int end = hunk->offset + hunk->length;
+	int first = ips_find_hunk(hunk->offset);
+	int last = first; // hunks [first, last) overlap the new one
+	ips_hunk left, right, pieces[3];
+	int count = 0;
+	
+	while (last < ips_hunkcount && ips_hunks[last].offset < end)
+		last++;
 	
-	if (ips_hunk_head == 0)
+	// keep the parts of the overlapped hunks that stick out either side.
+	if (first < last && ips_hunks[first].offset < hunk->offset)
 	{
-		ips_hunk_head = hunk;
+		left = ips_hunks[first];
+		left.length = hunk->offset - left.offset;
+		pieces[count++] = left;
+	}
+	
+	// sequential output usually just extends the previous hunk.
+	if (count == 0 && first > 0
+		&& ips_hunks[first - 1].offset + ips_hunks[first - 1].length == hunk->offset
+		&& ips_can_merge(&ips_hunks[first - 1], hunk))
+	{
+		ips_hunks[first - 1].length += hunk->length;
 	}
 	else
+		pieces[count++] = *hunk;
+	
+	if (first < last && ips_hunks[last - 1].offset + ips_hunks[last - 1].length > end)
 	{
-		ips_hunk_tail->next = hunk;
+		right = ips_hunks[last - 1];
+		if (right.contents)
+			right.contents += end - right.offset;
+		right.length -= end - right.offset;
+		right.offset = end;
+		pieces[count++] = right;
 	}
 	
-	ips_hunk_tail = hunk;
+	// make room and put the pieces in place of the overlapped hunks.
+	if (ips_hunkcount - (last - first) + count > ips_hunkmax)
+	{
+		ips_hunk* newhunks;
+		int newmax = ips_hunkmax ? ips_hunkmax * 2 : 256;
+		newhunks = (ips_hunk*)realloc(ips_hunks, newmax * sizeof(ips_hunk));
+		if (!newhunks)
+			fatal_error( "out of memory" );
+		ips_hunks = newhunks;
+		ips_hunkmax = newmax;
+	}
+	memmove(ips_hunks + first + count, ips_hunks + last, (ips_hunkcount - last) * sizeof(ips_hunk));
+	memcpy(ips_hunks + first, pieces, count * sizeof(ips_hunk));
+	ips_hunkcount += count - (last - first);
 }
 
 void write_ips_hunk_regular(FILE* f, size_t offset, byte *p, size_t count)
@@ -2193,147 +4749,78 @@ void write_ips_hunk_rle(FILE* f, size_t offset, byte b, size_t count)
 	}
 }
 
-void ips_free_hunk(ips_hunk* hunk)
-{
-	if (hunk->contents)
-	{
-		free(hunk->contents);
-	}
-	free(hunk);
-}
-
-int ips_changed = 0;
-
-// combines/swaps adjacent/overlapping hunks.
-// bubble sort ips entries.
-// returns true if a change was made.
-void ips_simplify_hunk(ips_hunk** hunk_ptr)
+// writes `count` bytes from `p`, which go at `offset`, in as few patch
+// bytes as possible. cost[i] is the cheapest encoding of the first i bytes;
+// a record is either literal (5 + length bytes) or RLE (8 bytes), holds at
+// most 0xffff bytes and can't start at IPS_EOF.
+void ips_write_run(FILE* output, int offset, byte* p, int count)
 {
-	ips_hunk* hunk;
-	ips_hunk* next;
-	
-tail_recurse:
-	hunk = *hunk_ptr;
-	if (hunk == 0) return;
-	next = hunk->next;
-	
-	// this node is not used.
-	if (hunk->suppress || hunk->length == 0) goto remove_node;
-	
-	// update tail
-	ips_hunk_tail = hunk;
-	
-	// reached end.
-	if (next == 0) return;
-	
-	// don't merge with suppressed chunk
-	if (next->suppress)
-	{
-		// continue
-		hunk_ptr = &hunk->next;
-		goto tail_recurse;
-	};
-	
-	// totally contained in the next one?
-	if (hunk->offset >= next->offset
-		&& hunk->offset + hunk->length <= next->offset + next->length)
-	{
-		goto remove_node;
-	}
+	int* cost = (int*)my_malloc((count + 1) * sizeof(int));
+	int* from = (int*)my_malloc((count + 1) * sizeof(int)); // record start (~start for RLE)
+	int* queue = (int*)my_malloc((count + 1) * sizeof(int));
+	int head = 0, tail = 0;
+	int rlestart = 0; // start of the run of equal bytes ending at i-1
+	int i, j, records;
 	
-	// the next one starts after this one
-	if (next->offset > hunk->offset)
+	cost[0] = 0;
+	for (i = 1; i <= count; ++i)
 	{
-		// but they overlap
-		if (hunk->offset + hunk->length > next->offset)
+		// literal records: queue holds the possible starts in the last 0xffff
+		// bytes, with cost[j]-j increasing, so the best one is at the head.
+		j = i - 1;
+		if (offset + j != IPS_EOF)
 		{
-			// truncate this one
-			ips_changed = 1;
-			hunk->length = next->offset - hunk->offset;
+			while (tail > head && cost[queue[tail - 1]] - queue[tail - 1] >= cost[j] - j)
+				tail--;
+			queue[tail++] = j;
 		}
-		else
+		while (queue[head] < i - 0xffff)
+			head++;
+		cost[i] = cost[queue[head]] + 5 + i - queue[head];
+		from[i] = queue[head];
+		
+		// RLE records: cost never decreases, so start the run as early as possible.
+		if (i > 1 && p[i - 1] != p[i - 2])
+			rlestart = i - 1;
+		j = (rlestart > i - 0xffff) ? rlestart : i - 0xffff;
+		if (offset + j == IPS_EOF)
+			j++;
+		if (j < i && cost[j] + 8 < cost[i])
 		{
-			// no change; proceed to the next one.
-			hunk_ptr = &hunk->next;
-			goto tail_recurse;
+			cost[i] = cost[j] + 8;
+			from[i] = ~j;
 		}
 	}
-	// the next one is totally contained in this one?
-	else if (next->offset >= hunk->offset
-		&& next->offset + next->length <= hunk->offset + hunk->length)
+	
+	// walk back from the end to find where each record ends, then write them in order.
+	records = 0;
+	for (i = count; i > 0; i = (from[i] < 0) ? ~from[i] : from[i])
+		queue[records++] = i;
+	while (records--)
 	{
-		ips_changed = 1;
-		
-		// duplicate us to appear after theirs
-		if (next->offset + next->length < hunk->offset + hunk->length)
+		i = queue[records];
+		j = from[i];
+		if (j < 0)
 		{
-			ips_hunk* newhunk = (ips_hunk*)my_malloc(sizeof(ips_hunk));
-			newhunk->offset = next->offset + next->length;
-			newhunk->length = hunk->offset + hunk->length - newhunk->offset;
-			if (hunk->contents)
-			{
-				hunk->contents = (byte*)my_malloc(newhunk->length);
-				memcpy(
-					hunk->contents,
-					hunk->contents + newhunk->offset - hunk->offset,
-					newhunk->length
-				);
-			}
-			else
-			{
-				newhunk->contents = 0;
-				newhunk->rle_content = hunk->rle_content;
-			}
-			newhunk->next = next->next;
+			write_ips_hunk_rle(output, offset + ~j, p[~j], i - ~j);
 		}
-		
-		// truncate our length
-		hunk->length = next->offset - hunk->offset;
-	}
-	// the next one starts before this one
-	else if (next->offset < hunk->offset)
-	{
-		ips_changed = 1;
-		
-		if (next->offset + next->length > hunk->offset)
+		else
 		{
-			// not disjoint.
-			// truncate ours from the left.
-			
-			int removed = next->offset + next->length - hunk->offset;
-			
-			hunk->length -= removed;
-			if (hunk->contents)
-			{
-				memmove(hunk->contents, hunk->contents + removed, hunk->length);
-			}
+			write_ips_hunk_regular(output, offset + j, p + j, i - j);
 		}
-		
-		// swap
-		*hunk_ptr = next;
-		hunk->next = next->next;
-		next->next = hunk;
-		
-		// proceed from the new location of this hunk.
-		hunk_ptr = &next->next;
-		goto tail_recurse;
-	}
-	
-	if (0)
-	{
-	remove_node:
-		ips_changed = 1;
-		*hunk_ptr = next;
-		ips_free_hunk(hunk);
 	}
 	
-	// retry this node
-	goto tail_recurse;
+	free(cost);
+	free(from);
+	free(queue);
 }
 
 // writes all hunks to the output file.
 void ips_write(FILE* output)
 {
+	byte* run = 0;
+	int runsize = 0;
+	
 	assert(genips);
 	
 	// write IPS header.
@@ -2343,26 +4830,45 @@ void ips_write(FILE* output)
 		return;
 	}
 	
-	// O(n^2)
-	while (1) {
-		ips_simplify_hunk(&ips_hunk_head);
-		if (!ips_changed) break;
-		ips_changed = 0;
-	};
-	
-	// write hunks
-	for (ips_hunk* hunk = ips_hunk_head; hunk != 0; hunk = hunk->next)
+	// hunks are sorted and don't overlap; each stretch of adjacent ones is
+	// encoded from scratch, regardless of how it was flushed.
+	for (int i = 0; i < ips_hunkcount; )
 	{
-		if (hunk->suppress) continue;
-		if (hunk->contents)
+		int start, end, k, pos;
+		
+		if (ips_hunks[i].suppress)
 		{
-			write_ips_hunk_regular(output, hunk->offset, hunk->contents, hunk->length);
+			i++;
+			continue;
 		}
-		else
+		start = end = ips_hunks[i].offset;
+		for (k = i; k < ips_hunkcount && !ips_hunks[k].suppress && ips_hunks[k].offset == end; ++k)
+			end += ips_hunks[k].length;
+		
+		// nothing may start at the EOF offset, so begin one byte early
+		// (rewriting that byte with what the image already has there).
+		pos = (start == IPS_EOF) ? 1 : 0;
+		if (end - start + pos > runsize)
 		{
-			write_ips_hunk_rle(output, hunk->offset, hunk->rle_content, hunk->length);
+			free(run);
+			runsize = end - start + pos;
+			run = (byte*)my_malloc(runsize);
+		}
+		if (pos)
+			run[0] = romimage[start - 1];
+		for (; i < k; ++i)
+		{
+			ips_hunk* hunk = &ips_hunks[i];
+			if (hunk->contents)
+				memcpy(run + pos, hunk->contents, hunk->length);
+			else
+				memset(run + pos, hunk->rle_content, hunk->length);
+			pos += hunk->length;
 		}
+		
+		ips_write_run(output, end - pos, run, pos);
 	}
+	free(run);
 	
 	if ( fwrite("EOF", 3, 1, output) < 1 )
 	{
@@ -2373,101 +4879,316 @@ void ips_write(FILE* output)
 
 void flush_output_ips()
 {	
-	// write IPS hunks.
-	if (outcount == 0)
-	{
-		// do nothing.
-	}
-	else if (outcount <= 3)
-	{
-		// RLE is never a good choice for hunks this small.
-		ips_append_hunk(malloc_ips_hunk_regular(ips_outpos, outputbuff, outcount));
-	}
-	else
+	// (ips_write picks the encoding, so this is stored as-is.)
+	if (outcount > 0)
 	{
-		// split into RLE and non-RLE hunks
-		size_t hunk_start = 0;
-		size_t rle_start = 0;
-		byte rle_cmp = outputbuff[0];
-		for (size_t i = 0; i <= outcount; ++i)
-		{
-			int b = (i == outcount)
-				? -1
-				: outputbuff[i];
-			if (b != (int) rle_cmp)
-			{
-				if (i - rle_start >= IPS_RLE_EXTRACT)
-				{
-					if (rle_start > hunk_start)
-					{
-						ips_append_hunk(malloc_ips_hunk_regular(
-							ips_outpos + hunk_start, outputbuff + hunk_start, rle_start - hunk_start
-						));
-					}
-					ips_append_hunk(malloc_ips_hunk_rle(
-						ips_outpos + rle_start, rle_cmp, i - rle_start
-					));
-					hunk_start = i;
-				}
-				else if (b == -1)
-				{
-					ips_append_hunk(malloc_ips_hunk_regular(
-						ips_outpos + hunk_start, outputbuff + hunk_start, i - hunk_start
-					));
-					break;
-				}
-				
-				rle_start = i;
-				rle_cmp = b;
-			}
-		}
+		ips_add_regular(ips_outpos, outputbuff, outcount);
 	}
 	ips_outpos += outcount;
 }
 
 // removes all hunks from the list.
+// (the hunks themselves are in passarena, which is reset at the start of each pass.)
 void ips_clear()
 {
 	// force output flush because
 	// output buffer may be written to ips eventually.
 	flush_output(1);
 	
-	// clear list.
-	for (ips_hunk* hunk = ips_hunk_head; hunk != 0; )
+	ips_hunkcount = 0;
+}
+
+// growable buffer that BPS/UPS patches are built in.
+typedef struct {
+	byte* data;
+	size_t size;
+	size_t max;
+} patchbuff;
+
+void patch_bytes(patchbuff* pb, const void* p, size_t count)
+{
+	if (pb->size + count > pb->max)
+	{
+		byte* newdata;
+		size_t newmax = pb->max ? pb->max * 2 : 0x10000;
+		while (newmax < pb->size + count) newmax *= 2;
+		newdata = (byte*)realloc(pb->data, newmax);
+		if (!newdata)
+			fatal_error( "out of memory" );
+		pb->data = newdata;
+		pb->max = newmax;
+	}
+	memcpy(pb->data + pb->size, p, count);
+	pb->size += count;
+}
+
+void patch_byte(patchbuff* pb, byte b)
+{
+	patch_bytes(pb, &b, 1);
+}
+
+// variable-length number, as used by both BPS and UPS.
+void patch_number(patchbuff* pb, size_t n)
+{
+	while (1)
+	{
+		byte b = n & 0x7f;
+		n >>= 7;
+		if (!n)
+		{
+			patch_byte(pb, b | 0x80);
+			break;
+		}
+		patch_byte(pb, b);
+		n--;
+	}
+}
+
+unsigned crc32_update(unsigned crc, const byte* p, size_t count)
+{
+	static unsigned table[256];
+	
+	if (!table[1])
 	{
-		if (hunk->contents)
+		for (unsigned i = 0; i < 256; ++i)
 		{
-			free(hunk->contents);
+			unsigned c = i;
+			for (int k = 0; k < 8; ++k)
+				c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+			table[i] = c;
 		}
-		ips_hunk* tmp = hunk;
-		hunk = hunk->next;
-		free(tmp);
 	}
+	crc = ~crc;
+	while (count--)
+		crc = table[(crc ^ *p++) & 0xff] ^ (crc >> 8);
+	return ~crc;
+}
+
+// BPS and UPS both end with the crc32 of the source, the target and the patch itself.
+void patch_crcs(patchbuff* pb, const byte* src, int srcsize, const byte* dst, int dstsize)
+{
+	unsigned crc[2];
+	byte b[4];
 	
-	ips_hunk_head = 0;
-	ips_hunk_tail = 0;
+	crc[0] = crc32_update(0, src, srcsize);
+	crc[1] = crc32_update(0, dst, dstsize);
+	for (int i = 0; i < 3; ++i)
+	{
+		unsigned c = (i < 2) ? crc[i] : crc32_update(0, pb->data, pb->size);
+		b[0] = c;
+		b[1] = c >> 8;
+		b[2] = c >> 16;
+		b[3] = c >> 24;
+		patch_bytes(pb, b, 4);
+	}
 }
 
-// gets cmp value in ips file
-int ips_get_cmp_value(size_t location)
+// UPS: runs of source^target bytes, each ended by a 0.
+void ups_build(patchbuff* pb, const byte* src, int srcsize, const byte* dst, int dstsize)
 {
-	assert(genips);
-	int value = -1;
-	for (ips_hunk* hunk = ips_hunk_head; hunk != 0; hunk = hunk->next)
+	int size = (srcsize > dstsize) ? srcsize : dstsize;
+	int i = 0, last = 0;
+	
+	patch_bytes(pb, "UPS1", 4);
+	patch_number(pb, srcsize);
+	patch_number(pb, dstsize);
+	while (i < size)
 	{
-		if (hunk->offset <= location && location < hunk->offset + hunk->length)
+		byte x = ((i < srcsize) ? src[i] : 0) ^ ((i < dstsize) ? dst[i] : 0);
+		if (!x)
 		{
-			if (hunk->contents)
+			i++;
+			continue;
+		}
+		patch_number(pb, i - last);
+		while (i < size && (x = ((i < srcsize) ? src[i] : 0) ^ ((i < dstsize) ? dst[i] : 0)))
+		{
+			patch_byte(pb, x);
+			i++;
+		}
+		patch_byte(pb, 0);
+		last = ++i;
+	}
+	patch_crcs(pb, src, srcsize, dst, dstsize);
+}
+
+enum bpsactions {SOURCEREAD=0,TARGETREAD=1,SOURCECOPY=2,TARGETCOPY=3};
+#define BPS_HASHBITS 16
+#define BPS_MINMATCH 4 // shorter matches are written as TargetRead data
+
+static unsigned bps_hash(const byte* p)
+{
+	return ((p[0] | p[1] << 8 | p[2] << 16 | (unsigned)p[3] << 24) * 2654435761u) >> (32 - BPS_HASHBITS);
+}
+
+// signed offset relative to the last copy, as BPS stores them.
+static void bps_offset(patchbuff* pb, int from, int* rel)
+{
+	int d = from - *rel;
+	patch_number(pb, (d < 0) ? ((size_t)-d << 1) | 1 : (size_t)d << 1);
+}
+
+// BPS: greedy longest match at each position, out of the same offset in the
+// source (SourceRead), anywhere in the source (SourceCopy) or earlier in the
+// target (TargetCopy). Candidates come from hash tables of 4-byte strings.
+void bps_build(patchbuff* pb, const byte* src, int srcsize, const byte* dst, int dstsize)
+{
+	int* srctable = (int*)my_malloc(sizeof(int) << BPS_HASHBITS);
+	int* dsttable = (int*)my_malloc(sizeof(int) << BPS_HASHBITS);
+	int out = 0, literal = 0, srcrel = 0, dstrel = 0;
+	
+	memset(srctable, -1, sizeof(int) << BPS_HASHBITS);
+	memset(dsttable, -1, sizeof(int) << BPS_HASHBITS);
+	for (int i = 0; i + 4 <= srcsize; ++i)
+		srctable[bps_hash(src + i)] = i;
+	
+	patch_bytes(pb, "BPS1", 4);
+	patch_number(pb, srcsize);
+	patch_number(pb, dstsize);
+	patch_number(pb, 0); // no metadata
+	
+	while (out < dstsize)
+	{
+		int best, action = SOURCEREAD, from = 0, len, j;
+		
+		for (best = 0; out + best < dstsize && out + best < srcsize && src[out + best] == dst[out + best]; best++);
+		if (out + 4 <= dstsize)
+		{
+			j = srctable[bps_hash(dst + out)];
+			if (j >= 0)
 			{
-				value = hunk->contents[location - hunk->offset];
+				for (len = 0; out + len < dstsize && j + len < srcsize && src[j + len] == dst[out + len]; len++);
+				if (len > best)
+				{
+					best = len;
+					action = SOURCECOPY;
+					from = j;
+				}
 			}
-			else
+			j = dsttable[bps_hash(dst + out)];
+			if (j >= 0)
 			{
-				value = hunk->rle_content;
+				// (may overlap what it's writing, for repeated patterns)
+				for (len = 0; out + len < dstsize && dst[j + len] == dst[out + len]; len++);
+				if (len > best)
+				{
+					best = len;
+					action = TARGETCOPY;
+					from = j;
+				}
 			}
 		}
+		if (best < BPS_MINMATCH)
+		{
+			if (out + 4 <= dstsize)
+				dsttable[bps_hash(dst + out)] = out;
+			out++;
+			continue;
+		}
+		
+		if (literal < out)
+		{
+			patch_number(pb, ((size_t)(out - literal - 1) << 2) | TARGETREAD);
+			patch_bytes(pb, dst + literal, out - literal);
+		}
+		patch_number(pb, ((size_t)(best - 1) << 2) | action);
+		if (action == SOURCECOPY)
+		{
+			bps_offset(pb, from, &srcrel);
+			srcrel = from + best;
+		}
+		else if (action == TARGETCOPY)
+		{
+			bps_offset(pb, from, &dstrel);
+			dstrel = from + best;
+		}
+		for (len = 0; len < best; len++, out++)
+			if (out + 4 <= dstsize)
+				dsttable[bps_hash(dst + out)] = out;
+		literal = out;
+	}
+	if (literal < out)
+	{
+		patch_number(pb, ((size_t)(out - literal - 1) << 2) | TARGETREAD);
+		patch_bytes(pb, dst + literal, out - literal);
+	}
+	patch_crcs(pb, src, srcsize, dst, dstsize);
+	
+	free(srctable);
+	free(dsttable);
+}
+
+void write_patchbuff(patchbuff* pb, char* filename)
+{
+	FILE* f = openoutput(filename, "wb");
+	
+	if (!f)
+		fatal_error(CantCreateFile);
+	if (fwrite(pb->data, 1, pb->size, f) < pb->size) {
+		fclose(f);
+		fatal_error(CantWrite);
+	}
+	if (fclose(f))
+		fatal_error(CantWrite);
+	message("%s written (%i bytes).\n", filename, (int)pb->size);
+}
+
+// writes the -b/-u patches, which turn the INCNES rom into the output image.
+void write_deltapatches()
+{
+	patchbuff pb = {0, 0, 0};
+	binfile* bf = getbinfile(baseromname);
+	byte* base;
+	int basesize;
+	
+	if (!bf)
+		fatal_error(CantOpen);
+	base = bf->data;
+	basesize = bf->size;
+	
+	if (genbps)
+	{
+		bps_build(&pb, base, basesize, romimage, filesize);
+		write_patchbuff(&pb, bpsfilename);
+	}
+	if (genups)
+	{
+		pb.size = 0;
+		ups_build(&pb, base, basesize, romimage, filesize);
+		write_patchbuff(&pb, upsfilename);
+	}
+	free(pb.data);
+}
+
+// gets cmp value in ips file
+int ips_get_cmp_value(size_t location)
+{
+	// hunk that answered the last lookup; compares mostly read forward.
+	static int last = 0;
+	ips_hunk* hunk;
+	
+	assert(genips);
+	if (last >= ips_hunkcount || ips_hunks[last].offset > (int)location
+		|| ips_hunks[last].offset + ips_hunks[last].length <= (int)location)
+	{
+		if (last + 1 < ips_hunkcount && ips_hunks[last + 1].offset <= (int)location
+			&& ips_hunks[last + 1].offset + ips_hunks[last + 1].length > (int)location)
+			last++;
+		else
+			last = ips_find_hunk(location);
+	}
+	if (last >= ips_hunkcount || ips_hunks[last].offset > (int)location)
+		return -1;
+	
+	hunk = &ips_hunks[last];
+	if (hunk->contents)
+	{
+		return hunk->contents[location - hunk->offset];
+	}
+	else
+	{
+		return hunk->rle_content;
 	}
-	return value;
 }
 
 // gets output value at the given position
@@ -2480,20 +5201,59 @@ int get_cmp_value(size_t location)
 	}
 	else
 	{
-		// TODO optimize
-		int b;
-		size_t prevseek = ftell(outputfile);
-		fseek(outputfile, location, SEEK_SET);
-		if (fread(&b,1,1,outputfile) < 1)
+		if (location >= (size_t)filesize)
 		{
-			b = -1;
+			return -1;
 		}
-		fseek(outputfile, prevseek, SEEK_SET);
-		return b;
+		return romimage[location];
+	}
+}
+
+// makes sure romimage (and cdlimage with -c) can hold at least size bytes.
+void image_reserve(int size)
+{
+	if (size > romimagesize)
+	{
+		byte* newimage;
+		int newsize = romimagesize ? romimagesize * 2 : 0x10000;
+		while (newsize < size) newsize *= 2;
+		newimage = (byte*)realloc(romimage, newsize);
+		if (!newimage)
+			fatal_error( "out of memory" );
+		romimage = newimage;
+		romimagesize = newsize;
+	}
+	// (checked separately: a --batch job can turn on -c after romimage has grown)
+	if (gencdl && cdlimagesize < romimagesize)
+	{
+		byte* newimage = (byte*)realloc(cdlimage, romimagesize);
+		if (!newimage)
+			fatal_error( "out of memory" );
+		cdlimage = newimage;
+		cdlimagesize = romimagesize;
 	}
 }
 
+// writes the cdl map, which covers the same bytes as the output file.
+void write_cdl()
+{
+	// cdl file is headerless
+	int start = ines_include ? HEADERSIZE : 0;
+	int size = filesize - start;
+	FILE *f = openoutput(cdlfilename, "wb");
+	
+	if (!f)
+		fatal_error(CantCreateFile);
+	if (size > 0 && fwrite(cdlimage + start, 1, size, f) < (size_t)size) {
+		fclose(f);
+		fatal_error(CantWrite);
+	}
+	if (fclose(f))
+		fatal_error(CantWrite);
+}
+
 // flushes output buffer
+// (only used to collect IPS hunks; the image is written to directly.)
 void flush_output(int force)
 {
 	if(outcount>=BUFFSIZE || force || (genips && outcount >= 0xffff)) {
@@ -2503,72 +5263,120 @@ void flush_output(int force)
 			flush_output_ips();
 		}
 		
-		// flush binary output
-		if (outputfile)
-		{
-			if(fwrite(outputbuff,1,outcount,outputfile)<outcount || fflush(outputfile))
-				errmsg=CantWrite;
-		}
-			
 		// clear buffer
 		outcount=0;
 	}
 }
 
+// returns the first position in [pos, pos+count) that already holds
+// something other than the filler value, or -1 if there is none.
+int compare_filler(int pos, int count)
+{
+	static byte block[256];
+	static int blockvalue = -1;
+	const byte* p;
+	const byte* end;
+	
+	if (genips)
+	{
+		// only bytes covered by a hunk are compared.
+		int end = pos + count;
+		for (int i = ips_find_hunk(pos); i < ips_hunkcount && ips_hunks[i].offset < end; ++i)
+		{
+			ips_hunk* hunk = &ips_hunks[i];
+			int from = hunk->offset > pos ? hunk->offset : pos;
+			int to = hunk->offset + hunk->length < end ? hunk->offset + hunk->length : end;
+			if (!hunk->contents)
+			{
+				if (hunk->rle_content != defaultfiller)
+					return from;
+				continue;
+			}
+			for (; from < to; ++from)
+				if (hunk->contents[from - hunk->offset] != defaultfiller)
+					return from;
+		}
+		return -1;
+	}
+	
+	// the image is compared a block at a time.
+	if (pos >= filesize)
+		return -1;
+	if (defaultfiller < 0 || defaultfiller > 0xff)
+		return pos;
+	if (blockvalue != defaultfiller)
+	{
+		blockvalue = defaultfiller;
+		memset(block, blockvalue, sizeof(block));
+	}
+	p = romimage + pos;
+	end = romimage + (filesize - pos < count ? filesize : pos + count);
+	while (end - p >= (ptrdiff_t)sizeof(block) && !memcmp(p, block, sizeof(block)))
+		p += sizeof(block);
+	while (p < end && *p == blockvalue)
+		p++;
+	return p < end ? (int)(p - romimage) : -1;
+}
+
 // directly adds bytes to output buffer.
 void output_buffer(byte* p, size_t count)
 {
-	for (size_t i = 0; i < count; ++i)
+	const char* failed = 0;
+	
+	if (genips && filepos + count > IPS_MAXSIZE)
+	{
+		errmsg = IPSOutOfRange;
+		return;
+	}
+	
+	image_reserve(filepos + count);
+	
+	// compare (only what comes before a mismatch gets output)
+	if (comparefiller)
 	{
-		// compare
-		if (comparefiller)
+		int loc = compare_filler(filepos, (int)count);
+		if (loc >= 0)
 		{
-			int b = get_cmp_value(filepos + i);
-			if (b != defaultfiller && b >= 0)
-			{
-				errmsg = CompFailed;
-				int loc = filepos + outcount;
-				sprintf(CompFailed + 26, "%0*x was 0x%x.", 6, loc, b);
-				return;
-			}
+			// (keep reporting the first mismatch on this line)
+			if (errmsg != compfailmsg)
+				sprintf(compfailmsg, CompFailed, loc, get_cmp_value(loc));
+			failed = compfailmsg;
+			count = loc - filepos;
 		}
+	}
+	
+	for (size_t i = 0; i < count; ++i)
+	{
+		// write to image
+		romimage[filepos + i] = *p;
 		
-		// write to outputbuffer
-		outputbuff[outcount++]=*p;
+		// and to outputbuffer, for the IPS hunks
+		if (genips)
+		{
+			outputbuff[outcount++]=*p;
+			flush_output(0);
+		}
 		
 		p++;
 		
-		flush_output(0);
-		
 		if (errmsg)
 		{
 			return;
 		}
 	}
+	
+	if (failed)
+		errmsg = failed;
 }
 
 // checks if we need to start a new file for outputting to.
 void output_file()
 {
-	// pass number for previous pass.
-	// note that the first pass is pass=1.
-	static int oldpass=0;
-	
 	if (nooutput) return;
 	
-	// if we're generating a CDL file.
-	if (gencdl) {
-		if(oldpass != pass) {
-			if(cdlfile) {
-				fclose(cdlfile);
-			}
-			cdlfile = fopen(cdlfilename, "wb+");
-		}
-	}
-	
 	// when starting a new pass, reopen file and possibly insert iNES header.
-	if(oldpass!=pass) {
-		oldpass=pass;
+	if(outputpass!=pass) {
+		outputpass=pass;
 		
 		if (genips)
 		{
@@ -2576,16 +5384,11 @@ void output_file()
 			ips_outpos = 0;
 		}
 		
-		// binary output.
-		if(outputfile) fclose(outputfile);
-		outputfile=fopen(outputfilename,"wb+");
+		// binary output (starts over from an empty image).
+		outputstarted=1;
 		assert(filepos == 0);
 		assert(filesize == 0);
 		outcount=0;
-		if(!outputfile) {
-			errmsg=CantCreateFile;
-			return;
-		}
 
 		// (insert iNES header if needed)
 		if (ines_include) {
@@ -2615,6 +5418,19 @@ void output_file()
 	}
 }
 
+// marks the next `count` bytes at filepos in the cdl map.
+// PRG (addr < $10000) is marked as either code or data, CHR as 0.
+void cdl_mark(int count, int cdlflag)
+{
+	int prg = count;
+	
+	if (addr + prg > 0x10000)
+		prg = (addr < 0x10000) ? 0x10000 - addr : 0;
+	image_reserve(filepos + count);
+	memset(cdlimage + filepos, cdlflag, prg);
+	memset(cdlimage + filepos + prg, NONE, count - prg);
+}
+
 // writes `size` bytes from `p` to output file.
 // cdlflag is used when generating cdlfiles.
 // It should be one of the cdl types (NONE, DATA, or CODE).
@@ -2623,36 +5439,27 @@ void output(byte *p,int size, int cdlflag) {
 	// ensure we have a file that we're outputting to.
 	output_file();
 	
-	// update cdl file
-	if(gencdl && !nooutput) {
-		if(cdlfile && (!ines_include || filepos >= HEADERSIZE)) {
-			int repeat = size;
-			while(repeat--) {
-				if(addr < 0x10000) {
-					//PRG, mark as either code or data
-					byte flag = (byte)cdlflag;
-					fwrite((void*)&flag, 1, 1, cdlfile);
-				} else {
-					//CHR data
-					fwrite("\x0", 1, 1, cdlfile);
-				}
-			}
-		}
-	}
+	// update cdl map
+	if(gencdl && !nooutput)
+		cdl_mark(size, cdlflag);
+	if(gendbg && !nooutput)
+		dbg_addbytes(size);
+	
+	if(memorec)
+		memo_bytes(p, size, cdlflag);
 	
 	// advance the memory address.
 	addr+=size;
 	
 	if (nooutput)
 		return;
-	
-	if(!outputfile && !genips) return;
+	profbytes += size;
 	
 	// write data.
 	output_buffer(p, size);
 	
 	while(size--) {
-		if(listfile && listcount<LISTMAX)
+		if(listfilename && listcount<LISTMAX)
 			listbuff[listcount]=*p;
 		listcount++;
 		p++;
@@ -2663,6 +5470,86 @@ void output(byte *p,int size, int cdlflag) {
 	}
 }
 
+// writes `count` copies of `val`, the same as calling output() once per byte
+// but in bulk: the image is memset and IPS data goes out as RLE hunks.
+void output_fill(byte val, int count, int cdlflag)
+{
+	int i, n;
+	
+	if (count <= 0)
+		return;
+	memook = 0;
+	
+	// ensure we have a file that we're outputting to.
+	output_file();
+	
+	// update cdl map
+	if(gencdl && !nooutput)
+		cdl_mark(count, cdlflag);
+	if(gendbg && !nooutput)
+		dbg_addbytes(count);
+	
+	// advance the memory address.
+	addr += count;
+	
+	if (nooutput)
+		return;
+	profbytes += count;
+	
+	// compare (only what comes before a mismatch gets output)
+	n = count;
+	if (comparefiller)
+	{
+		int loc = compare_filler(filepos, count);
+		if (loc >= 0)
+		{
+			if (errmsg != compfailmsg)
+				sprintf(compfailmsg, CompFailed, loc, get_cmp_value(loc));
+			errmsg = compfailmsg;
+			n = loc - filepos;
+		}
+	}
+	
+	if (genips && filepos + count > IPS_MAXSIZE)
+	{
+		errmsg = IPSOutOfRange;
+		return;
+	}
+	
+	// write data.
+	image_reserve(filepos + count);
+	memset(romimage + filepos, val, n);
+	if (genips)
+	{
+		if (n >= IPS_RLE_EXTRACT)
+		{
+			flush_output(1);
+			ips_add_rle(ips_outpos, val, n);
+			ips_outpos += n;
+		}
+		else
+		{
+			for (i = 0; i < n; ++i)
+			{
+				outputbuff[outcount++] = val;
+				flush_output(0);
+			}
+		}
+	}
+	
+	for (i = 0; i < count && listcount < LISTMAX; ++i)
+	{
+		if(listfilename)
+			listbuff[listcount]=val;
+		listcount++;
+	}
+	listcount += count - i;
+	
+	// update filepos and filesize
+	filepos += count;
+	if (filepos > filesize) filesize = filepos;
+}
+
 /* Outputs integer as little-endian. See readme.txt for proper usage. */
 static void output_le( int n, int size, int cdlflag )
 {
@@ -2689,61 +5576,20 @@ void output_seek(int pos)
 	
 	flush_output(1);
 	
-	// seek in cdlfile.
-	if (gencdl)
+	if (pos < 0)
 	{
-		if (cdlfile)
-		{
-			int cdlpos = (pos < filesize)
-				? pos
-				: filesize;
-			// cdl file is headerless
-			if (ines_include) cdlpos -= HEADERSIZE;
-			// clamp
-			if (cdlpos < 0) cdlpos = 0;
-			if (fflush(cdlfile))
-			{
-				errmsg = CantWrite;
-				return;
-			}
-			fseek(cdlfile, cdlpos, SEEK_SET);
-			if (ftell(cdlfile) != cdlpos)
-			{
-				errmsg = CantSeek;
-				return;
-			}
-		}
+		errmsg = SeekOutOfRange;
+		return;
 	}
 	
-	// FIXME: we don't actually need a file in order to set the next output position.
-	// Additionally, there is no need to pad until a write actually occurs.
-	
-	if (outputfile)
+	if (pos > filesize)
 	{
-		// seek in outputfile.
-		if (pos > filesize)
-		{
-			// past end of file -- pad with zeros
-			filepos = filesize;
-			ips_outpos = filepos;
-			fseek(outputfile, filepos, SEEK_SET);
-			while (filepos < pos)
-			{
-				output(&padbyte, 1, NONE);
-			}
-		}
-		else if (pos < filesize)
-		{
-			// within file bounds -- seek there.
-			filepos = pos;
-			fseek(outputfile, filepos, SEEK_SET);
-		}
-	
-		if (filepos != ftell(outputfile))
-		{
-			errmsg = CantSeek;
-		}
-	} 
+		// past end of file -- pad with filler
+		filepos = filesize;
+		ips_outpos = filepos;
+		output_fill(padbyte, pos - filepos, NONE);
+		flush_output(1);
+	}
 	
 	filepos = pos;
 	ips_outpos = pos;
@@ -2752,57 +5598,585 @@ void output_seek(int pos)
 	addr = prevaddr;
 }
 
+// one listed line. its bytes and error are filled in when the next line starts.
+// (records live in passarena, so only the last pass's are left to write.)
+typedef struct listrec_t {
+	int pc;//address at the start of the line
+	int count;//bytes output by the line (only the first LISTMAX are kept)
+	byte bytes[LISTMAX];
+	const char *err;
+	char *text;//source line and comment
+	struct listrec_t *next;
+} listrec;
+
+listrec *listhead=0;
+listrec *listtail=0;
+
+void writelisting(void);
+
 //end listing when src=0
-char srcbuff[LINEMAX];
 void listline(char *src,char *comment) {
-	static int oldpass=0;
-	int i;
+	listrec *rec;
+	size_t n,m;
 	if(!listfilename)
 		return;
-	if(oldpass!=pass) {//new pass = new listfile
-		oldpass=pass;
-		if(listfile) fclose(listfile);
-		listfile=fopen(listfilename,"w");
-		if(!listfile) {
-			listfilename=0;//stop trying
-			// todo - if user wants a listing, this SHOULD be an error, otherwise
-			// he might still have old listing and think it's the current one.
-			// For example, he might have had it open in a text editor, preventing its
-			// creation here.
-			fputs("Can't create list file.", stderr);//not critical, just give a warning
-			return;
-		}
-	} else {//finish previous line
-		for(i=0;i<listcount && i<LISTMAX;i++)
-			fprintf(listfile," %02X",(int)listbuff[i]);
-		for(;i<LISTMAX;i++)
-			fprintf(listfile,"   ");
-		fputs(listcount>LISTMAX?".. ":"   ",listfile);
-		fputs(srcbuff,listfile);
-		if(listerr) {
-			fprintf(listfile,"*** %s\n",listerr);
-			listerr=0;
-		}
+	if(listpass!=pass) {//new pass = new listing
+		listpass=pass;
+		listhead=listtail=0;
+	} else if(listtail) {//finish previous line
+		listtail->count=listcount;
+		memcpy(listtail->bytes,listbuff,LISTMAX);
+		listtail->err=listerr;
+		listerr=0;
 	}
 	listcount=0;
 	if(src) {
-		if(addr<0)
-			fprintf(listfile,"	 ");
-		else
-			fprintf(listfile,"%05X",(int)addr);
-		strcpy(srcbuff,src);//make a copy of the original source line
+		n=strlen(src);
+		m=comment?strlen(comment):0;
+		rec=(listrec*)arena_alloc(&passarena,sizeof(listrec),MEM_LISTING);
+		rec->pc=addr;
+		rec->count=0;
+		rec->err=0;
+		rec->next=0;
+		rec->text=(char*)arena_alloc(&passarena,n+m+1,MEM_LISTING);//make a copy of the original source line
+		memcpy(rec->text,src,n);
 		if(comment) {
-			strcat(srcbuff, comment);
+			memcpy(rec->text+n,comment,m);
 			if(genmesenlabels && filepos > 0 && addr < 0x10000 && addr >= 0) {
 				//save this comment - needed for export
 				addcomment(comment);
 			}
 		}
+		rec->text[n+m]=0;
+		if(listtail)
+			listtail->next=rec;
+		else
+			listhead=rec;
+		listtail=rec;
+	} else
+		writelisting();
+}
+
+#define LISTBUFFSIZE 0x10000
+char listout[LISTBUFFSIZE];//formatted listing waiting to be written
+
+// copies text into listout, writing it to f whenever it fills up.
+static int listput(FILE *f,int n,const char *text,size_t len) {
+	while(n+len>LISTBUFFSIZE) {
+		size_t part=LISTBUFFSIZE-n;
+		memcpy(listout+n,text,part);
+		fwrite(listout,1,LISTBUFFSIZE,f);
+		text+=part;
+		len-=part;
+		n=0;
+	}
+	memcpy(listout+n,text,len);
+	return n+len;
+}
+
+//format the recorded lines into the list file
+void writelisting(void) {
+	static const char hexdigits[]="0123456789ABCDEF";
+	char field[64];
+	listrec *rec;
+	int n=0,i,k,v;
+	FILE *f=openoutput(listfilename,"w");
+	if(!f) {
+		// todo - if user wants a listing, this SHOULD be an error, otherwise
+		// he might still have old listing and think it's the current one.
+		// For example, he might have had it open in a text editor, preventing its
+		// creation here.
+		diagnostic("Can't create list file.");//not critical, just give a warning
+		return;
+	}
+	for(rec=listhead;rec;rec=rec->next) {
+		// address and bytes: "%05X" then " %02X" per byte
+		k=0;
+		if(rec->pc<0) {
+			field[k++]='\t';
+			field[k++]=' ';
+		} else {
+			for(i=7;i>4 && !(rec->pc>>(i*4));i--);
+			for(;i>=0;i--)
+				field[k++]=hexdigits[(rec->pc>>(i*4))&15];
+		}
+		for(i=0;i<LISTMAX;i++) {
+			field[k++]=' ';
+			if(i<rec->count) {
+				v=rec->bytes[i];
+				field[k++]=hexdigits[v>>4];
+				field[k++]=hexdigits[v&15];
+			} else {
+				field[k++]=' ';
+				field[k++]=' ';
+			}
+		}
+		field[k++]=rec->count>LISTMAX?'.':' ';
+		field[k++]=rec->count>LISTMAX?'.':' ';
+		field[k++]=' ';
+		n=listput(f,n,field,k);
+		n=listput(f,n,rec->text,strlen(rec->text));
+		if(rec->err) {
+			n=listput(f,n,"*** ",4);
+			n=listput(f,n,rec->err,strlen(rec->err));
+			n=listput(f,n,"\n",1);
+		}
+	}
+	fwrite(listout,1,n,f);
+	fclose(f);
+	message("%s written.\n",listfilename);
+}
+//------------------------------------------------------
+// debug database (-g/-G): which source line put each byte where, plus all symbols.
+// like the listing, it's rebuilt every pass and only the last pass is written.
+
+typedef struct {
+	int file;		//string index of the source file
+	int line;		//line in that file
+	int chain;		//string index of the macro/REPT expansion chain (-1 if none)
+	int chainline;	//line within the innermost expansion
+	int pc;			//address of the first byte
+	int pos;		//file offset of the first byte
+	int size;		//number of bytes
+	int scope;
+	int seq;		//(line number while assembling, to know when to start a new record)
+} dbgrec;
+
+dbgrec *dbgrecs=0;
+int dbgcount=0;
+int dbgmax=0;
+char **dbgstrings=0;//file names and expansion chains
+int dbgstringcount=0;
+int dbgstringmax=0;//also the size of dbgstringhash (power of 2, kept at most half full)
+int *dbgstringhash=0;//string index+1, open addressing
+
+void dbg_reset() {
+	dbgcount=0;
+	dbgstringcount=0;
+	if(dbgstringhash)
+		memset(dbgstringhash,0,dbgstringmax*sizeof(int));
+}
+
+//index of the given string in dbgstrings, adding it if it's new
+int dbg_string(const char *str) {
+	unsigned h=hashname(str);
+	int i;
+	if(2*(dbgstringcount+1)>dbgstringmax) {
+		int newmax=dbgstringmax ? dbgstringmax*2 : 256;
+		free(dbgstringhash);
+		dbgstringhash=(int*)my_malloc(newmax*sizeof(int));
+		memset(dbgstringhash,0,newmax*sizeof(int));
+		dbgstrings=(char**)realloc(dbgstrings,newmax*sizeof(char*));
+		if(!dbgstrings)
+			fatal_error("out of memory");
+		dbgstringmax=newmax;
+		for(i=0;i<dbgstringcount;i++) {
+			unsigned j=hashname(dbgstrings[i])&(newmax-1);
+			while(dbgstringhash[j])
+				j=(j+1)&(newmax-1);
+			dbgstringhash[j]=i+1;
+		}
+	}
+	for(i=h&(dbgstringmax-1);dbgstringhash[i];i=(i+1)&(dbgstringmax-1))
+		if(!strcmp(dbgstrings[dbgstringhash[i]-1],str))
+			return dbgstringhash[i]-1;
+	dbgstrings[dbgstringcount]=arena_strdup(&passarena,str,MEM_DEBUG);
+	dbgstringhash[i]=++dbgstringcount;
+	return dbgstringcount-1;
+}
+
+//called by output() before `count` bytes are written at filepos/addr
+void dbg_addbytes(int count) {
+	dbgrec *rec;
+	if(dbgcount) {
+		rec=&dbgrecs[dbgcount-1];
+		if(rec->seq==dbgseq && rec->pos+rec->size==filepos && rec->pc+rec->size==addr) {
+			rec->size+=count;
+			return;
+		}
+	}
+	if(dbgcount==dbgmax) {
+		dbgmax=dbgmax ? dbgmax*2 : 1024;
+		dbgrecs=(dbgrec*)realloc(dbgrecs,dbgmax*sizeof(dbgrec));
+		if(!dbgrecs)
+			fatal_error("out of memory");
+	}
+	rec=&dbgrecs[dbgcount++];
+	rec->file=dbg_string(dbgfile ? dbgfile : "");
+	rec->line=dbgfileline;
+	rec->chain=insidemacro ? dbg_string(dbgsrc) : -1;
+	rec->chainline=insidemacro ? dbgline : 0;
+	rec->pc=addr;
+	rec->pos=filepos;
+	rec->size=count;
+	rec->scope=scope;
+	rec->seq=dbgseq;
+}
+
+static void dbg_u32(FILE *f,unsigned v) {
+	byte b[4];
+	b[0]=v;
+	b[1]=v>>8;
+	b[2]=v>>16;
+	b[3]=v>>24;
+	fwrite(b,1,4,f);
+}
+
+//JSON string, with quotes and escapes
+static void dbg_jsonstr(FILE *f,const char *str) {
+	fputc('"',f);
+	for(;*str;str++) {
+		if(*str=='"' || *str=='\\')
+			fputc('\\',f);
+		if((byte)*str<0x20)
+			fprintf(f,"\\u%04x",(byte)*str);
+		else
+			fputc(*str,f);
+	}
+	fputc('"',f);
+}
+
+//writes the debug database (see readme.txt for the layout)
+void export_dbg() {
+	int i,n;
+	label *l;
+	label **list;
+	char *filename;
+	FILE *f;
+
+	filename=replace_ext(outputfilename,gendbg==2 ? ".dbg.json" : ".dbg");
+	f=openoutput(filename,gendbg==2 ? "w" : "wb");
+	free(filename);
+	if(!f) {
+		diagnostic("Can't create debug file.");
+		return;
+	}
+
+	list=allsymbols(&n);
+	qsort(list,n,sizeof(label*),comparelabels);
+
+	if(gendbg==2) {
+		fputs("{\"version\":1,\n\"strings\":[",f);
+		for(i=0;i<dbgstringcount;i++) {
+			if(i) fputc(',',f);
+			dbg_jsonstr(f,dbgstrings[i]);
+		}
+		fputs("],\n\"lines\":[",f);
+		for(i=0;i<dbgcount;i++) {
+			dbgrec *rec=&dbgrecs[i];
+			fprintf(f,"%s\n[%d,%d,%d,%d,%d,%d,%d,%d]",i ? "," : "",
+				rec->file,rec->line,rec->chain,rec->chainline,rec->pc,rec->pos,rec->size,rec->scope);
+		}
+		fputs("],\n\"symbols\":[",f);
+		for(i=0;i<n;i++) {
+			l=list[i];
+			fputs(i ? ",\n[" : "\n[",f);
+			dbg_jsonstr(f,l->name);
+			fprintf(f,",%d,%d,%d,%d,",l->type,
+				l->type==EQUATE ? 0 : (int)l->value,l->type==LABEL ? l->pos : -1,l->scope);
+			dbg_jsonstr(f,l->type==EQUATE ? l->line : "");
+			fputc(']',f);
+		}
+		fputs("]}\n",f);
 	} else {
-		fclose(listfile);
-		message("%s written.\n",listfilename);
+		fwrite("A6DB",1,4,f);
+		dbg_u32(f,1);//version
+		dbg_u32(f,dbgstringcount);
+		for(i=0;i<dbgstringcount;i++)
+			fwrite(dbgstrings[i],1,strlen(dbgstrings[i])+1,f);
+		dbg_u32(f,dbgcount);
+		for(i=0;i<dbgcount;i++) {
+			dbgrec *rec=&dbgrecs[i];
+			dbg_u32(f,rec->file);
+			dbg_u32(f,rec->line);
+			dbg_u32(f,rec->chain);
+			dbg_u32(f,rec->chainline);
+			dbg_u32(f,rec->pc);
+			dbg_u32(f,rec->pos);
+			dbg_u32(f,rec->size);
+			dbg_u32(f,rec->scope);
+		}
+		dbg_u32(f,n);
+		for(i=0;i<n;i++) {
+			l=list[i];
+			fwrite(l->name,1,strlen(l->name)+1,f);
+			fputc(l->type,f);//(LABEL, VALUE, EQUATE are 0, 1, 2, as in the readme)
+			dbg_u32(f,l->type==EQUATE ? 0 : l->value);
+			dbg_u32(f,l->type==LABEL ? l->pos : -1);
+			dbg_u32(f,l->scope);
+			if(l->type==EQUATE)
+				fwrite(l->line,1,strlen(l->line)+1,f);
+			else
+				fputc(0,f);
+		}
+	}
+	fclose(f);
+	free(list);
+}
+
+//------------------------------------------------------
+// profiler (--profile): time, calls and bytes output per top-level source line,
+// macro, REPT, INCLUDE and INCBIN, summed over all passes. times include
+// everything done on behalf of the entry (a macro's time includes its lines).
+
+const char *profkindnames[]={"line","macro","rept","include","incbin","pass"};
+
+typedef struct {
+	const char *name;	//source file, macro or included file (NULL for an empty slot)
+	int line;
+	int kind;
+	unsigned hash;
+	int calls;
+	double time;		//seconds
+	int bytes;
+} profentry;
+
+//one timed call, for the trace (source lines are only in the report)
+typedef struct {
+	const char *name;
+	int line;
+	int kind;
+	int pass;
+	double start;
+	double time;
+} profevent;
+
+#define PROFEVENTMAX 1000000	//trace events kept (the report covers everything)
+
+profentry *profentries=0;//hash table, open addressing
+int profcount=0;
+int profmax=0;//(power of 2, kept at most half full)
+profevent *profevents=0;
+int profeventcount=0;
+int profeventmax=0;
+double profstart=0;//time of the first measurement
+
+//forget everything measured so far
+void prof_reset(void) {
+	if(profentries)
+		memset(profentries,0,profmax*sizeof(profentry));
+	profcount=0;
+	profeventcount=0;
+	profstart=0;
+}
+
+double prof_now(void) {
+	struct timespec ts;
+	timespec_get(&ts,TIME_UTC);
+	if(!profstart)
+		profstart=ts.tv_sec+ts.tv_nsec*1e-9;
+	return ts.tv_sec+ts.tv_nsec*1e-9;
+}
+
+//find (or add) the entry for this kind/name/line
+profentry *prof_entry(int kind,const char *name,int line) {
+	unsigned h=hashname(name)^((unsigned)line*2654435761u)^kind;
+	unsigned mask;
+	int i,j;
+	if((profcount+1)*2>profmax) {
+		profentry *old=profentries;
+		int oldmax=profmax;
+		profmax=profmax ? profmax*2 : 1024;
+		profentries=(profentry*)my_malloc(profmax*sizeof(profentry));
+		memset(profentries,0,profmax*sizeof(profentry));
+		for(i=0;i<oldmax;i++) {
+			if(!old[i].name)
+				continue;
+			for(j=old[i].hash&(profmax-1);profentries[j].name;j=(j+1)&(profmax-1));
+			profentries[j]=old[i];
+		}
+		free(old);
+	}
+	mask=profmax-1;
+	for(i=h&mask;profentries[i].name;i=(i+1)&mask) {
+		profentry *e=&profentries[i];
+		if(e->hash==h && e->kind==kind && e->line==line && !strcmp(e->name,name))
+			return e;
+	}
+	profentries[i].name=arena_strdup(&asmarena,name,MEM_NAMES);
+	profentries[i].line=line;
+	profentries[i].kind=kind;
+	profentries[i].hash=h;
+	profcount++;
+	return &profentries[i];
+}
+
+//account for a call that started at t0, when profbytes was b0
+void prof_end(int kind,const char *name,int line,double t0,int b0) {
+	double t=prof_now();
+	profentry *e=prof_entry(kind,name,line);
+	e->calls++;
+	e->time+=t-t0;
+	e->bytes+=profbytes-b0;
+	if(kind!=PROF_LINE && profeventcount<PROFEVENTMAX) {
+		profevent *ev;
+		if(profeventcount==profeventmax) {
+			profeventmax=profeventmax ? profeventmax*2 : 1024;
+			profevents=(profevent*)realloc(profevents,profeventmax*sizeof(profevent));
+			if(!profevents)
+				fatal_error("out of memory");
+		}
+		ev=&profevents[profeventcount++];
+		ev->name=e->name;
+		ev->line=line;
+		ev->kind=kind;
+		ev->pass=pass;
+		ev->start=t0-profstart;
+		ev->time=t-t0;
+	}
+}
+
+int compareprofentries(const void* arg1, const void* arg2)
+{
+	const profentry* a = *((profentry**)arg1);
+	const profentry* b = *((profentry**)arg2);
+	if(a->time < b->time) return 1;
+	if(a->time > b->time) return -1;
+	return strcmp(a->name, b->name);
+}
+
+//name of an entry as shown in the report and trace
+static void prof_where(char *str,const char *name,int kind,int line) {
+	if(kind==PROF_LINE || kind==PROF_REPT)
+		sprintf(str,"%.400s(%i)%s",name,line,kind==PROF_REPT ? ":REPT" : "");
+	else if(kind==PROF_PASS)
+		sprintf(str,"pass %i",line);
+	else
+		sprintf(str,"%.400s",name);
+}
+
+//writes <output>.prof (report sorted by time) and <output>.trace.json (Chrome trace events)
+void export_profile() {
+	profentry **list;
+	char str[512];
+	char *filename;
+	FILE *f;
+	int i,n=0;
+
+	list=(profentry**)my_malloc((profcount+1)*sizeof(profentry*));
+	for(i=0;i<profmax;i++)
+		if(profentries[i].name)
+			list[n++]=&profentries[i];
+	qsort(list,n,sizeof(profentry*),compareprofentries);
+
+	filename=replace_ext(outputfilename,".prof");
+	f=openoutput(filename,"w");
+	if(f) {
+		fprintf(f,"%12s %10s %10s  %-8s %s\n","seconds","calls","bytes","kind","where");
+		for(i=0;i<n;i++) {
+			prof_where(str,list[i]->name,list[i]->kind,list[i]->line);
+			fprintf(f,"%12.6f %10i %10i  %-8s %s\n",list[i]->time,list[i]->calls,list[i]->bytes,
+				profkindnames[list[i]->kind],str);
+		}
+		fclose(f);
+		message("%s written.\n",filename);
+	}
+	free(filename);
+	free(list);
+
+	filename=replace_ext(outputfilename,".trace.json");
+	f=openoutput(filename,"w");
+	if(f) {
+		fputs("{\"traceEvents\":[",f);
+		for(i=0;i<profeventcount;i++) {
+			profevent *ev=&profevents[i];
+			prof_where(str,ev->name,ev->kind,ev->line);
+			fputs(i ? ",\n" : "\n",f);
+			fputs("{\"name\":",f);
+			dbg_jsonstr(f,str);
+			fprintf(f,",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1,\"args\":{\"pass\":%i}}",
+				profkindnames[ev->kind],ev->start*1e6,ev->time*1e6,ev->pass);
+		}
+		fputs("\n]}\n",f);
+		fclose(f);
+		message("%s written.\n",filename);
 	}
+	free(filename);
+}
+
+//------------------------------------------------------
+// pass report (--pass-report): what made another pass necessary.
+// notes are collected while a pass runs and printed when it's done.
+
+typedef struct {
+	int kind;			//passnotekinds
+	const char *name;	//label, or branch instruction
+	int oldval;			//old label value, or branch distance
+	int newval;
+	const char *where;	//source (or expansion chain) and line
+	int line;
+	int seq;			//(source line being processed, to skip repeats)
+} passnoteinfo;
+
+#define PASSREPORTMAX 50	//notes of each kind shown per pass
+
+passnoteinfo *passnotes=0;
+int passnotecount=0;
+int passnotemax=0;
+
+void passnote(int kind,const char *name,int oldval,int newval) {
+	passnoteinfo *n;
+	int i;
+	//the same line can be evaluated more than once (e.g. trying addressing modes)
+	for(i=passnotecount-1;i>=0 && passnotes[i].seq==dbgseq;i--)
+		if(passnotes[i].kind==kind && !strcmp(passnotes[i].name,name))
+			return;
+	if(passnotecount==passnotemax) {
+		passnotemax=passnotemax ? passnotemax*2 : 256;
+		passnotes=(passnoteinfo*)realloc(passnotes,passnotemax*sizeof(passnoteinfo));
+		if(!passnotes)
+			fatal_error("out of memory");
+	}
+	n=&passnotes[passnotecount++];
+	n->kind=kind;
+	n->name=arena_strdup(&passarena,name,MEM_NAMES);
+	n->oldval=oldval;
+	n->newval=newval;
+	n->where=arena_strdup(&passarena,dbgsrc ? dbgsrc : "",MEM_NAMES);
+	n->line=dbgline;
+	n->seq=dbgseq;
+}
+
+//prints the notes for the pass that just finished
+void pass_report(double time) {
+	static const char *headings[NOTE_COUNT]={"labels that moved","unresolved symbols","branches out of range"};
+	int kind,i,count,shown;
+	printf("pass %i: %.3f s, %i lines reused\n",pass,time,memohits);
+	for(kind=0;kind<NOTE_COUNT;kind++) {
+		count=0;
+		for(i=0;i<passnotecount;i++)
+			count+=passnotes[i].kind==kind;
+		if(!count)
+			continue;
+		printf("  %s: %i\n",headings[kind],count);
+		for(i=shown=0;i<passnotecount && shown<PASSREPORTMAX;i++) {
+			passnoteinfo *n=&passnotes[i];
+			if(n->kind!=kind)
+				continue;
+			shown++;
+			if(kind==NOTE_MOVED)
+				printf("    %s: $%X -> $%X",n->name,n->oldval,n->newval);
+			else if(kind==NOTE_UNRESOLVED)
+				printf("    %s",n->name);
+			else
+				printf("    %s by %i bytes",n->name,n->oldval);
+			printf("  %s(%i)\n",n->where,n->line);
+		}
+		if(count>shown)
+			printf("    (%i more)\n",count-shown);
+	}
+	if(error)
+		puts("  stopping because of errors");
+	else if(!needanotherpass)
+		puts("  no further pass needed");
+	else if(lastchance)
+		puts("  giving up (this was the last try)");
+	else
+		puts("  another pass is needed");
+	passnotecount=0;
+	memohits=0;
 }
+
 //------------------------------------------------------
 //directive(label *id, char **next)
 //
@@ -2819,7 +6193,7 @@ void equ(label *id, char **next) {
 			reverse(str,s+strspn(s,whitesp));	   //eat whitesp off both ends
 			reverse(s,str+strspn(str,whitesp));
 			if(*s) {
-				(*labelhere).line=my_strdup(s);
+				(*labelhere).line=arena_strdup(&asmarena,s,MEM_EQUATES);
 				(*labelhere).type=EQUATE;
 			} else {
 				errmsg=IncompleteExp;
@@ -2894,36 +6268,54 @@ void nothing(label *id, char **next) {
 
 void include(label *id,char **next) {
 	char *np;
-	FILE *f;
+	sourcefile *sf;
+	pchfile *pf=0;
 
 	np=*next;
 	reverse(tmpstr,np+strspn(np,whitesp2));	 //eat whitesp off both ends
 	reverse(np,tmpstr+strspn(tmpstr,whitesp2));
-	f=fopen(np,"r+");   //read as text, the + makes recursion not possible
-	if(!f) {
+	if(pchdir && includenest && !insidemacro && !listfilename)
+		pf=getpchfile(np);
+	if(pf && pf->data && pch_apply(pf)) {//(no need to read the file at all)
+		errmsg=0;
+		*next=np+strlen(np);
+		return;
+	}
+	sf=getsourcefile(np);
+	if(!sf) {
 		errmsg=CantOpen;
 		error=1;
+	} else if(sf->busy) {
+		errmsg=RecurseINCLUDE;
+		error=1;
 	} else {
-		processfile(f,np);
-		fclose(f);
+		double t0=profiling ? prof_now() : 0;
+		int b0=profbytes;
+		int recording=pf && !pf->data && !pf->recorded && pch_start(pf);
+		processfile(sf);
+		if(recording)
+			pch_finish();
 		errmsg=0;//let main() know file was ok
+		if(profiling)
+			prof_end(PROF_INCLUDE,sf->name,0,t0,b0);
 	}
 	*next=np+strlen(np);//need to play safe because this could be the main srcfile
 }
 
 void incbin(label *id,char **next) {
 	int filesize, seekpos, bytesleft, i;
-	FILE *f=0;
+	binfile *bf;
+	double t0=profiling ? prof_now() : 0;
+	int b0=profbytes;
 
 	do {
 	//file open:
 		getfilename(tmpstr,next);
-		if(!(f=fopen(tmpstr,"rb"))) {
+		if(!(bf=getbinfile(tmpstr))) {
 			errmsg=CantOpen;
 			break;
 		}
-		fseek(f,0,SEEK_END);
-		filesize=ftell(f);
+		filesize=bf->size;
 	//file seek:
 		seekpos=0;
 		if(eatchar(next,','))
@@ -2931,13 +6323,16 @@ void incbin(label *id,char **next) {
 		if(!errmsg && !dependant) if(seekpos<0 || seekpos>filesize)
 			errmsg=SeekOutOfRange;
 		if(errmsg) break;
-		fseek(f,seekpos,SEEK_SET);
+		if(seekpos<0 || seekpos>filesize)//(unknown yet, there will be another pass)
+			seekpos=filesize;
 	//get size:
 		if(eatchar(next,',')) {
 			bytesleft=eval(next,WHOLEEXP);
 			if(!errmsg && !dependant) if(bytesleft<0 || bytesleft>(filesize-seekpos))
 				errmsg=BadIncbinSize;
 			if(errmsg) break;
+			if(bytesleft<0 || bytesleft>(filesize-seekpos))
+				bytesleft=0;
 		} else {
 			bytesleft=filesize-seekpos;
 		}
@@ -2945,22 +6340,23 @@ void incbin(label *id,char **next) {
 		while(bytesleft) {
 			if(bytesleft>BUFFSIZE) i=BUFFSIZE;
 			else i=bytesleft;
-			fread(inputbuff,1,i,f);
-			output(inputbuff,i,DATA);
+			output(bf->data+seekpos,i,DATA);
+			seekpos+=i;
 			bytesleft-=i;
 		}
 	} while(0);
-	if(f) fclose(f);
+	if(profiling)
+		prof_end(PROF_INCBIN,tmpstr,0,t0,b0);
 }
 
 void incnes(label *id, char **next) {
 	char filename[WORDMAX];
 	char buf[WORDMAX + 2];
 	int filesize, seekpos, bytesleft, i;
-	int cdlbytesleft, cdli, cdlstart, cdlflag;
-	char cdlbuf[STACKBUFFSIZE];
-	FILE *f=0;
-	FILE *cdl=0;
+	int cdlbytesleft=0, cdli, cdlstart, cdlflag;
+	byte *cdlbuf=0;
+	binfile *bf;
+	binfile *cdl=0;
 	
 	// get string-wrapped filename.
 	buf[0] = '"';
@@ -2974,12 +6370,13 @@ void incnes(label *id, char **next) {
 	// include binary
 	do {
 	//file open:
-		if(!(f=fopen(filename,"rb"))) {
+		if(!(bf=getbinfile(filename))) {
 			errmsg=CantOpen;
 			break;
 		}
-		fseek(f,0,SEEK_END);
-		filesize=ftell(f);
+		if(!baseromname)
+			baseromname=arena_strdup(&asmarena,filename,MEM_NAMES);
+		filesize=bf->size;
 		if (filesize < HEADERSIZE)
 		{
 			errmsg = SeekOutOfRange;
@@ -2989,23 +6386,18 @@ void incnes(label *id, char **next) {
 		if (gencdl)
 		{
 			s = replace_ext(filename, ".cdl");
-			if ((cdl = fopen(s, "rb")))
+			if ((cdl = getbinfile(s)))
 			{
-				fseek(cdl, 0, SEEK_END);
-				cdlbytesleft = ftell(cdl);
-				fseek(cdl, 0, SEEK_SET);
+				cdlbuf = cdl->data;
+				cdlbytesleft = cdl->size;
 				if (cdlbytesleft == 0)
-				{
-					fclose(cdl);
 					cdl = 0;
-				}
 			}
 			free(s);
 		}
 		
 	//file seek:
 		seekpos=HEADERSIZE;
-		fseek(f,HEADERSIZE,SEEK_SET);
 	//get size:
 		bytesleft=filesize-seekpos;
 	//read file:
@@ -3015,16 +6407,11 @@ void incnes(label *id, char **next) {
 			if (i>BUFFSIZE) i=BUFFSIZE;
 			if (cdl && i > cdlbytesleft) i = cdlbytesleft;
 			if (cdl && i > STACKBUFFSIZE) i = STACKBUFFSIZE;
-			fread(inputbuff,1,i,f);
 			if (cdl)
 			{
-				fread(cdlbuf, 1, i, cdl);
 				cdlbytesleft -= i;
 				if (!cdlbytesleft)
-				{
-					fclose(cdl);
 					cdl = 0;
-				}
 				
 				// output in sections of identical cdl.
 				
@@ -3034,18 +6421,18 @@ void incnes(label *id, char **next) {
 					cdlstart = cdli;
 					cdlflag = cdlbuf[cdli++];
 					for (; cdli < i && cdlbuf[cdli] == cdlflag; ++cdli);
-					output(inputbuff + cdlstart, cdli - cdlstart, cdlflag);
+					output(bf->data + seekpos + cdlstart, cdli - cdlstart, cdlflag);
 				}
+				cdlbuf += i;
 			}
 			else
 			{
-				output(inputbuff,i,NONE);
+				output(bf->data + seekpos,i,NONE);
 			}
+			seekpos+=i;
 			bytesleft-=i;
 		}
 	} while(0);
-	if(f) fclose(f);
-	if (cdl) fclose(cdl);
 }
 
 void clearpatch(label *id, char **next)
@@ -3057,9 +6444,9 @@ void clearpatch(label *id, char **next)
 		// mark sections as non-output.
 		// we don't remove them because we may wish to
 		// read from them (e.g. compare)
-		for (ips_hunk* hunk = ips_hunk_head; hunk != 0; hunk = hunk->next)
+		for (int i = 0; i < ips_hunkcount; ++i)
 		{
-			hunk->suppress = 1;
+			ips_hunks[i].suppress = 1;
 		}
 	}
 }
@@ -3187,8 +6574,7 @@ void filler(int count,char **next) {
 	if(!errmsg && !dependant) if(val>255 || val<-128 || count<0 || count>0x100000)
 		errmsg=OutOfRange;
 	if(errmsg) return;
-	while(count--)//!#@$
-		 output_le(val,1,NONE);
+	output_fill((byte)val,count,NONE);
 }
 
 void dsb(label *id,char **next) {
@@ -3258,10 +6644,13 @@ void opcode(label *id, char **next) {
 			if(!eatchar(&s,ophead[type])) continue;
 			val=eval(&s,WHOLEEXP);
 			if(type==REL) {
+				memoaddr=1;
 				if(!dependant) {
 					val-=addr+2;
 					if(val>127 || val<-128) {
 						needanotherpass=1;//give labels time to sort themselves out..
+						if(passreport)
+							passnote(NOTE_BRANCH,(*id).name,val,0);
 						if(lastchance)
 						{
 							errmsg="Branch out of range.";
@@ -3389,6 +6778,7 @@ void macro(label *id, char **next) {
 	char *src;
 	char word[WORDMAX];
 	int params;
+	macrodef *md;
 	
 	labelhere=0;
 	if(getlabel(word,next))
@@ -3400,15 +6790,18 @@ void macro(label *id, char **next) {
 	if(errmsg) {//no valid macro name
 		return;
 	} else if((*labelhere).type==LABEL) {//new macro
+		md=(macrodef*)arena_alloc(&asmarena,sizeof(macrodef),MEM_MACROS);
+		md->text=0;
+		md->lines=0;
 		(*labelhere).type=MACRO;
-		(*labelhere).line=0;
-		makemacro=&(*labelhere).line;
+		(*labelhere).line=(char*)md;
+		makemacro=&md->text;
 										//build param list
 		params=0;
 		src=*next;
 		while(getlabel(word,&src)) {//don't affect **next directly, make sure it's a good name first
 			*next=src;
-			*makemacro=my_malloc(strlen(word)+sizeof(char*)+1);
+			*makemacro=(char*)arena_alloc(&asmarena,strlen(word)+sizeof(char*)+1,MEM_MACROS);
 			makemacro=(char**)*makemacro;
 			strcpy((char*)&makemacro[1],word);
 			++params;
@@ -3424,32 +6817,96 @@ void macro(label *id, char **next) {
 	}
 }
 
+//turn the stored text of macro id into a template: lex every body line once and
+//mark each use of a param, so expansions only have to fill in the args.
+void compilemacro(label *id) {
+	macrodef *md=(macrodef*)(*id).line;
+	char **line=(char**)md->text;
+	char **body;
+	srcline *sl;
+	token *t;
+	int i,j,k,n;
+
+	md->paramcount=(*id).value;
+	md->params=(char**)arena_alloc(&asmarena,(md->paramcount+1)*sizeof(char*),MEM_MACROS);
+	md->needlabels=md->paramcount>MAXMACROARGS;
+	for(i=0;i<md->paramcount;i++) {
+		md->params[i]=(char*)&line[1];
+		n=*md->params[i];//'+', '-' and '$' params can't be found by lexline()
+		if(n!='_' && n!='.' && n!=LOCALCHAR && !(n>='A' && n<='Z') && !(n>='a' && n<='z'))
+			md->needlabels=1;
+		line=(char**)*line;
+	}
+
+	n=0;
+	for(body=line;body;body=(char**)*body)
+		n++;
+	md->lines=(srcline*)arena_alloc(&asmarena,n*sizeof(srcline),MEM_MACROS);
+	md->linecount=n;
+	for(i=0;i<n;i++) {
+		sl=&md->lines[i];
+		sl->text=(char*)&line[1];
+		lexline(sl,&asmarena,MEM_MACROS);
+		for(j=0;j<sl->ntoks;j++) {
+			t=&sl->toks[j];
+			if(t->ifdef)//IFDEF needs the args to exist as labels
+				md->needlabels=1;
+			t->slot=-1;
+			for(k=0;k<md->paramcount;k++) {
+				if((int)strlen(md->params[k])==t->len && !memcmp(md->params[k],sl->text+t->start,t->len)) {
+					t->slot=k+1;
+					break;
+				}
+			}
+		}
+		line=(char**)*line;
+	}
+}
+
 //errline=source file line number
 //errsrc=source file name
 void expandmacro(label *id,char **next,int errline,char *errsrc) {
-	//char argname[8];
 	char macroerr[WORDMAX*2];//this should be enough, i hope..
-	char **line;
-	int linecount=0;
+	char argtext[LINEMAX];//args copied out of the line, for the frame
+	macrodef *md;
+	macroframe frame,*oldframe;
+	int linecount;
 	int oldscope;
 	int arg, args;
-	char c,c2,*s,*s2,*s3;
+	char c,c2,*s,*s2,*s3,*dst;
+	label *p;
+	double t0=0;
+	int b0=0;
 	
 	if((*id).used) {
 		errmsg=RecurseMACRO;
 		return;
 	}
+	if(profiling) {
+		t0=prof_now();
+		b0=profbytes;
+	}
 
+	md=(macrodef*)(*id).line;
+	if(!md->lines)
+		compilemacro(id);
 	oldscope=scope;//watch those nested macros..
 	scope=nextscope++;
 	insidemacro++;
 	(*id).used=1;
 	sprintf(macroerr,"%s(%i):%s",errsrc,errline,(*id).name);
-	line=(char**)((*id).line);
+
+	frame.def=md;
+	frame.scope=scope;
+	for(arg=0;arg<md->paramcount && arg<MAXMACROARGS;arg++) {
+		frame.arg[arg]=0;
+		frame.used[arg]=0;
+	}
+	dst=argtext;
 
 	//define macro params
 	s=*next;
-	args=(*id).value;   //(named args)
+	args=md->paramcount;   //(named args)
 	arg=0;
 	do {
 		s+=strspn(s,whitesp);//eatwhitespace	s=param start
@@ -3470,13 +6927,22 @@ void expandmacro(label *id,char **next,int errline,char *errsrc) {
 		s2=s3;
 		*s2=0;		  
 		if(*s) {//arg not empty
-		//  sprintf(argname,"\\%i",arg);		//make indexed arg
-		//  addlabel(argname,1);
-		//  equ(0,&s);
 			if(arg<args) {			  //make named arg
-				addlabel((char*)&line[1],1);
-				equ(0,&s);
-				line=(char**)*line; //next arg name
+				if(md->needlabels) {
+					addlabel(md->params[arg],1);
+					equ(0,&s);
+				} else if(findparam(md,md->params[arg])==arg) {//(a repeated param name keeps the first arg)
+					//a VALUE with the same name can't be overridden, same as with addlabel(),
+					//but only one set earlier on this pass (a later one would win from pass 2 on)
+					p=findlabel(md->params[arg]);
+					if(!p || (*p).type!=VALUE || (*p).pass!=pass) {
+						s3=strend(s,whitesp);
+						frame.arg[arg]=dst;
+						memcpy(dst,s,s3-s);
+						dst+=s3-s;
+						*dst++=0;
+					}
+				}
 			}
 			arg++;
 		}
@@ -3485,63 +6951,71 @@ void expandmacro(label *id,char **next,int errline,char *errsrc) {
 	} while(eatchar(&s,','));
 	*next=s;
 
-	//make "\?" arg
-	//{..}
-
-	while(arg++ < args) //skip any unused arg names
-		line=(char**)*line;
-
-	while(line) {
-		linecount++;
-		processline((char*)&line[1],macroerr,linecount);		
-		line=(char**)*line;
-	}
+	oldframe=curframe;
+	curframe=md->needlabels ? 0 : &frame;
+	for(linecount=0;linecount<md->linecount;linecount++)
+		processsrcline(&md->lines[linecount],macroerr,linecount+1);
+	curframe=oldframe;
 	errmsg=0;
 	scope=oldscope;
 	insidemacro--;
 	(*id).used=0;
+	if(profiling)
+		prof_end(PROF_MACRO,(*id).name,0,t0,b0);
 }
 
 int rept_loops;
 char *repttext;//rept chain begins here
+arenamark reptmark;//reptarena is released back to here once the body is expanded
 void rept(label *id, char **next) {
 	dependant=0;
 	rept_loops=eval(next,WHOLEEXP);
 	if(dependant || errmsg || rept_loops<0)
 		rept_loops=0;
+	reptmark=arena_mark(&reptarena);
 	makerept=&repttext;
 	repttext=0;
 	reptcount++;//tell processline to start storing up rept lines
 }
 
+//the body is lexed once into srclines, then every iteration just replays them
 void expandrept(int errline,char *errsrc) {
 	char macroerr[WORDMAX*2];//source to show in listing (this should be enough, i hope?)
-	char **start,**line;
-	int linecount;
+	char **line;
+	srcline *lines=0;
+	int linecount,n=0;
 	int i,oldscope;
+	arenamark mark=reptmark;
+	double t0=0;
+	int b0=0;
 
-	start=(char**)repttext;//first rept data
+	if(profiling) {
+		t0=prof_now();
+		b0=profbytes;
+	}
+	if(rept_loops) {
+		for(line=(char**)repttext;line;line=(char**)*line)
+			n++;
+		lines=(srcline*)arena_alloc(&reptarena,n*sizeof(srcline),MEM_REPT);
+		for(i=0,line=(char**)repttext;i<n;i++,line=(char**)*line) {
+			lines[i].text=(char*)&line[1];
+			lexline(&lines[i],&reptarena,MEM_REPT);
+		}
+	}
 	oldscope=scope;
 	insidemacro++;
+	sprintf(macroerr,"%s(%i):REPT",errsrc,errline);
 	for(i=rept_loops;i;--i) {
-		linecount=0;
 		scope=nextscope++;
-		sprintf(macroerr,"%s(%i):REPT",errsrc,errline);
-		line=start;
-		while(line) {
-			linecount++;
-			processline((char*)&line[1],macroerr,linecount);
-			line=(char**)*line;
-		}
-	}
-	while(start) {//delete everything
-		line=(char**)*start;
-		free(start);
-		start=line;
+		for(linecount=0;linecount<n;linecount++)
+			processsrcline(&lines[linecount],macroerr,linecount+1);
 	}
+	arena_release(&reptarena,mark);//delete everything (and any nested REPTs that weren't finished)
 	errmsg=0;
 	scope=oldscope;
 	insidemacro--;
+	if(profiling)
+		prof_end(PROF_REPT,errsrc,errline,t0,b0);
 }
 
 int enum_saveaddr;
@@ -3656,8 +7130,7 @@ void inesmap(label *id, char **next) {
 }
 
 void incines(label *id,char **next) {
-	int filesize;
-	FILE *f=0;
+	binfile *bf;
 	
 	char header[ HEADERSIZE ];
 	int parse = 0;
@@ -3665,23 +7138,18 @@ void incines(label *id,char **next) {
 	do {
 	//file open:
 		getfilename(tmpstr,next);
-		if(!(f=fopen(tmpstr,"rb"))) {
+		if(!(bf=getbinfile(tmpstr))) {
 			errmsg=CantOpen;
 			break;
 		}
-		fseek(f,0,SEEK_END);
-		filesize=ftell(f);
-		if (filesize < sizeof(header)) {
+		if (bf->size < (long)sizeof(header)) {
 			errmsg = InvalidHeader;
 			break;
 		}
-	//file seek:
-		fseek(f, 0,SEEK_SET);
 	// file read:
-		fread(header, sizeof(header), 1, f);
+		memcpy(header, bf->data, sizeof(header));
 		parse = 1;
 	} while(0);
-	if (f) fclose(f);
 	
 	// parse the header that was just read.
 	if (parse) {
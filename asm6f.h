@@ -0,0 +1,79 @@
+/*  asm6f as a library.
+
+    Assembles from memory and hands back the ROM image, symbols and error
+    messages, without starting a process or writing any files.
+    Build asm6f.c with ASM6F_NO_MAIN defined ("make lib" builds libasm6f.a)
+    and include this header.
+
+    This is not a reentrant API. There is no assembler context: all of the
+    assembler's state is global, exactly as in the asm6f program, and
+    asm6f_assemble() resets and reuses it on every call. So:
+      - it is not thread-safe. Only one call may run at a time in a
+        process; callers on several threads must hold their own lock.
+      - it can't be called again from inside an asm6f_readfn callback.
+        Such a call fails (returns -1 with a diagnostic) without touching
+        the assembly that is running.
+    What it saves over running asm6f is the process start, the temporary
+    files, and reading files again: files read from disk stay cached
+    between calls until they change, and the reserved word table is only
+    built once.
+*/
+
+#ifndef ASM6F_H
+#define ASM6F_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//a file handed to the assembler from memory
+typedef struct {
+	const char *name;		//as the source refers to it (INCLUDE, INCBIN..) or the main source name
+	const void *data;
+	long size;
+} asm6f_file;
+
+//called for files that aren't in asm6f_options.files. return nonzero and set
+//*data and *size if the file exists. the data is copied right away.
+typedef int (*asm6f_readfn)(void *user,const char *name,const void **data,long *size);
+
+typedef struct {
+	const char *source;			//main source file
+	const char **defines;		//symbols to define (like -d), NULL-terminated. may be NULL
+	const asm6f_file *files;	//in-memory files. may be NULL
+	int filecount;
+	asm6f_readfn read;			//may be NULL. files not found in memory are read from disk
+	void *user;					//passed to read
+} asm6f_options;
+
+enum asm6f_symboltypes {ASM6F_LABEL,ASM6F_VALUE,ASM6F_EQUATE};
+
+typedef struct {
+	const char *name;
+	int type;				//asm6f_symboltypes
+	long value;				//address of a label, value of a symbol (0 for an equate)
+	long offset;			//where a label is in the ROM image, or -1
+	int scope;				//0=global, labels that share a name have different scopes
+	const char *text;		//what an equate stands for, NULL for other symbols
+} asm6f_symbol;
+
+typedef struct {
+	unsigned char *rom;		//assembled image, NULL if assembly failed
+	long romsize;
+	asm6f_symbol *symbols;	//every symbol, sorted by name
+	int symbolcount;
+	char *diagnostics;		//error messages, as the asm6f program would print them
+	int errors;				//nonzero if assembly failed
+} asm6f_result;
+
+//assemble, filling in result. returns 0 if it worked, -1 if there were errors.
+//result must be freed with asm6f_free() either way. not reentrant, see above.
+int asm6f_assemble(const asm6f_options *options,asm6f_result *result);
+
+void asm6f_free(asm6f_result *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,13 @@
+; assembled by both jobs in jobs.txt (see cmd), split between two processes
+
+	org $8000
+count = 0
+ifdef A
+	db "A"
+else
+	db "B"
+endif
+ifdef C
+count = 4
+endif
+	include ../include/table.inc
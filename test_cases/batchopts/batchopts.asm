@@ -0,0 +1,10 @@
+; assembled by every job in jobs.txt with different options (see cmd): the
+; jobs run in one process, so whatever one job's options leave behind has to
+; be right for the next one
+
+	org $8000
+start:
+	lda table,x
+	rts
+table:
+	db 1, 2, 3, 4
@@ -0,0 +1,12 @@
+; -b/-u: besides the .bin, build .bps and .ups patches from the INCNES rom
+; to it. some bytes change, a block moves, and the rom grows at the end
+
+	incnes ../rom/base.nes
+	seekabs $10+$40
+	db "patched"
+	seekabs $10+$100
+	incbin "../rom/base.nes", $10+$200, $80	; copied from further on
+	seekabs $10+$600
+	dsb $40, $ea
+	seekabs $10+$800
+	db 1, 2, 3, 4			; past the end
@@ -0,0 +1,9 @@
+; the first run assembles and keeps the outputs in _tmp/, the second run
+; finds nothing changed and copies them back without assembling
+
+	org $8000
+count = 1
+	include ../include/table.inc
+	incbin ../include/data.bin
+label:
+	jmp label
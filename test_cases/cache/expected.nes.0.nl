@@ -0,0 +1 @@
+$8009#label#
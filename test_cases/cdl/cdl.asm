@@ -0,0 +1,18 @@
+; -c: the code/data log starts from the one next to the INCNES rom, then
+; code and data written over it are marked, fills and padding are not
+
+	incnes ../rom/base.nes
+	seekabs $10+$100
+	base $8100
+	lda #1		; code
+	jmp ($fffc)
+	db 1, 2, 3	; data
+	dw $8100
+	hex 0102
+	dsb 4, $ea	; fills are not logged
+	seekabs $10+$500
+	base $8500
+	rts
+	seekabs $10+$7f0
+	dsb $20, 0	; past the end of the rom
+	db $11
@@ -0,0 +1,11 @@
+; with COMPARE on, every byte written over the INCNES rom must match the
+; FILLVALUE. the first db overwrites a 0, the second doesn't and must stop
+; the assembly with the offset and the old byte
+
+	incnes ../rom/base.nes
+	seekabs $10+97
+	fillvalue 0
+	compare
+	db $ff
+	db $ff
+	endcompare
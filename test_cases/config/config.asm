@@ -0,0 +1,15 @@
+; built once per --config (see args): each build gets its own symbols and
+; its own output names, _out.ntsc.bin, _out.pal.bin and
+; _out.plain.bin (no symbols)
+
+	org $8000
+ifdef PAL
+	db "pal"
+endif
+ifdef NTSC
+	db "ntsc"
+endif
+ifdef DEBUG
+	db $de
+endif
+	db 0
@@ -0,0 +1,19 @@
+; -G: every line that outputs bytes, and every symbol with its type as a
+; number (0=label, 1=value, 2=equate), same as in the binary .dbg
+
+MACRO twice v
+	db v, v
+ENDM
+
+	org $8000
+SPEED = 3
+PLAYER EQU $40
+reset:
+	lda #SPEED
+	sta PLAYER
+	twice 7
+@loop:
+	REPT 2
+	nop
+	ENDR
+	jmp @loop
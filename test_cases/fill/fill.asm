@@ -0,0 +1,23 @@
+; DSB, PAD, ALIGN, ORG and seek padding fill their gaps in bulk, with the
+; FILLVALUE in effect at the time (or the value given)
+
+	org $8000
+	db 1
+	dsb 5
+	dsb 3, $42
+	dsw 2, $1234
+	align 16
+	fillvalue $ff
+	db 2
+	align 8
+	pad $8030
+	pad $8034, $ea
+	align 4, $55
+	db 3
+	org $8040
+	fillvalue 0
+	dsb $1000, $99
+	seekabs $1000
+	db 4
+	fillvalue $77
+	align 256
@@ -0,0 +1,21 @@
+; the ROM is assembled into an image in memory and written once, so seeking
+; back over bytes, seeking past the end and BASE all have to end up in the
+; right place
+
+	org $c000
+start:
+	db 1, 2, 3, 4, 5, 6, 7, 8
+	seekabs 2
+	db $aa, $bb		; overwrites 3, 4
+	seekabs $20		; past the end, padded
+	db $cc
+	seekrel -$10
+	db $dd
+	skiprel 3
+	db $ee
+	seekabs $21
+	base $e000
+bank:
+	dw start, bank, $
+	org $e010
+	db $ff
@@ -0,0 +1,11 @@
+; the same include file is read from the source cache on every pass and
+; every time it's included; CRLF line endings are handled like LF ones
+
+	org $c000
+count = 0
+	include table.inc
+	include table.inc
+	incbin data.bin
+	incbin "data.bin", 2, 3
+	include crlf.inc
+	db count
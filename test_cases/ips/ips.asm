@@ -0,0 +1,27 @@
+; -i: only what's written over the INCNES rom goes in the .ips. runs of one
+; byte become RLE hunks, writes close together share a hunk, and bytes
+; written over again keep their last value
+
+	incnes ../rom/base.nes
+	clearpatch		; (the rom itself is not part of the patch)
+	seekabs $10
+	db $de, $ad
+	seekabs $20
+	dsb 100, $42		; RLE
+	hex 01020304
+	seekabs $200
+	db 1, 2, 3, 4, 5, 6, 7, 8, 9, 10
+	seekabs $204
+	db $aa			; over the middle of the last hunk
+	seekabs $1fe
+	db $bb, $bb		; just before it
+	seekabs $300
+	db 1
+	seekabs $303
+	db 2			; a short gap is cheaper to fill than a new hunk
+	seekabs $400
+	dsb 8, $77
+	db 1, 2
+	dsb 8, $77
+	seekabs $810
+	db $ff			; past the end of the rom
@@ -0,0 +1,19 @@
+; COMPARE with -i: the old bytes come from the patch's hunks (the INCNES rom
+; is kept after CLEARPATCH for this). a 0 byte of the rom and a byte this
+; patch already set to 0 pass; the last db lands on a rom byte that isn't 0
+
+	incnes ../rom/base.nes
+	clearpatch
+	fillvalue 0
+	seekabs $10+97*3
+	compare
+	db $ff
+	endcompare
+	seekabs $10+$300
+	dsb 4, 0
+	seekabs $10+$302
+	compare
+	db $ff
+	seekabs $10+97*5+1
+	db $ff
+	endcompare
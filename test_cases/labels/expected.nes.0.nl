@@ -0,0 +1,609 @@
+$8027#+#
+$800A#++#
+$8021#-#
+$800F#--#
+$8028#@a#
+$8BE0#@loop#
+$8014#first#
+$8BE5#last#
+$8028#second#
+$802D#sub0#
+$8032#sub1#
+$805F#sub10#
+$8221#sub100#
+$8226#sub101#
+$822B#sub102#
+$8230#sub103#
+$8235#sub104#
+$823A#sub105#
+$823F#sub106#
+$8244#sub107#
+$8249#sub108#
+$824E#sub109#
+$8064#sub11#
+$8253#sub110#
+$8258#sub111#
+$825D#sub112#
+$8262#sub113#
+$8267#sub114#
+$826C#sub115#
+$8271#sub116#
+$8276#sub117#
+$827B#sub118#
+$8280#sub119#
+$8069#sub12#
+$8285#sub120#
+$828A#sub121#
+$828F#sub122#
+$8294#sub123#
+$8299#sub124#
+$829E#sub125#
+$82A3#sub126#
+$82A8#sub127#
+$82AD#sub128#
+$82B2#sub129#
+$806E#sub13#
+$82B7#sub130#
+$82BC#sub131#
+$82C1#sub132#
+$82C6#sub133#
+$82CB#sub134#
+$82D0#sub135#
+$82D5#sub136#
+$82DA#sub137#
+$82DF#sub138#
+$82E4#sub139#
+$8073#sub14#
+$82E9#sub140#
+$82EE#sub141#
+$82F3#sub142#
+$82F8#sub143#
+$82FD#sub144#
+$8302#sub145#
+$8307#sub146#
+$830C#sub147#
+$8311#sub148#
+$8316#sub149#
+$8078#sub15#
+$831B#sub150#
+$8320#sub151#
+$8325#sub152#
+$832A#sub153#
+$832F#sub154#
+$8334#sub155#
+$8339#sub156#
+$833E#sub157#
+$8343#sub158#
+$8348#sub159#
+$807D#sub16#
+$834D#sub160#
+$8352#sub161#
+$8357#sub162#
+$835C#sub163#
+$8361#sub164#
+$8366#sub165#
+$836B#sub166#
+$8370#sub167#
+$8375#sub168#
+$837A#sub169#
+$8082#sub17#
+$837F#sub170#
+$8384#sub171#
+$8389#sub172#
+$838E#sub173#
+$8393#sub174#
+$8398#sub175#
+$839D#sub176#
+$83A2#sub177#
+$83A7#sub178#
+$83AC#sub179#
+$8087#sub18#
+$83B1#sub180#
+$83B6#sub181#
+$83BB#sub182#
+$83C0#sub183#
+$83C5#sub184#
+$83CA#sub185#
+$83CF#sub186#
+$83D4#sub187#
+$83D9#sub188#
+$83DE#sub189#
+$808C#sub19#
+$83E3#sub190#
+$83E8#sub191#
+$83ED#sub192#
+$83F2#sub193#
+$83F7#sub194#
+$83FC#sub195#
+$8401#sub196#
+$8406#sub197#
+$840B#sub198#
+$8410#sub199#
+$8037#sub2#
+$8091#sub20#
+$8415#sub200#
+$841A#sub201#
+$841F#sub202#
+$8424#sub203#
+$8429#sub204#
+$842E#sub205#
+$8433#sub206#
+$8438#sub207#
+$843D#sub208#
+$8442#sub209#
+$8096#sub21#
+$8447#sub210#
+$844C#sub211#
+$8451#sub212#
+$8456#sub213#
+$845B#sub214#
+$8460#sub215#
+$8465#sub216#
+$846A#sub217#
+$846F#sub218#
+$8474#sub219#
+$809B#sub22#
+$8479#sub220#
+$847E#sub221#
+$8483#sub222#
+$8488#sub223#
+$848D#sub224#
+$8492#sub225#
+$8497#sub226#
+$849C#sub227#
+$84A1#sub228#
+$84A6#sub229#
+$80A0#sub23#
+$84AB#sub230#
+$84B0#sub231#
+$84B5#sub232#
+$84BA#sub233#
+$84BF#sub234#
+$84C4#sub235#
+$84C9#sub236#
+$84CE#sub237#
+$84D3#sub238#
+$84D8#sub239#
+$80A5#sub24#
+$84DD#sub240#
+$84E2#sub241#
+$84E7#sub242#
+$84EC#sub243#
+$84F1#sub244#
+$84F6#sub245#
+$84FB#sub246#
+$8500#sub247#
+$8505#sub248#
+$850A#sub249#
+$80AA#sub25#
+$850F#sub250#
+$8514#sub251#
+$8519#sub252#
+$851E#sub253#
+$8523#sub254#
+$8528#sub255#
+$852D#sub256#
+$8532#sub257#
+$8537#sub258#
+$853C#sub259#
+$80AF#sub26#
+$8541#sub260#
+$8546#sub261#
+$854B#sub262#
+$8550#sub263#
+$8555#sub264#
+$855A#sub265#
+$855F#sub266#
+$8564#sub267#
+$8569#sub268#
+$856E#sub269#
+$80B4#sub27#
+$8573#sub270#
+$8578#sub271#
+$857D#sub272#
+$8582#sub273#
+$8587#sub274#
+$858C#sub275#
+$8591#sub276#
+$8596#sub277#
+$859B#sub278#
+$85A0#sub279#
+$80B9#sub28#
+$85A5#sub280#
+$85AA#sub281#
+$85AF#sub282#
+$85B4#sub283#
+$85B9#sub284#
+$85BE#sub285#
+$85C3#sub286#
+$85C8#sub287#
+$85CD#sub288#
+$85D2#sub289#
+$80BE#sub29#
+$85D7#sub290#
+$85DC#sub291#
+$85E1#sub292#
+$85E6#sub293#
+$85EB#sub294#
+$85F0#sub295#
+$85F5#sub296#
+$85FA#sub297#
+$85FF#sub298#
+$8604#sub299#
+$803C#sub3#
+$80C3#sub30#
+$8609#sub300#
+$860E#sub301#
+$8613#sub302#
+$8618#sub303#
+$861D#sub304#
+$8622#sub305#
+$8627#sub306#
+$862C#sub307#
+$8631#sub308#
+$8636#sub309#
+$80C8#sub31#
+$863B#sub310#
+$8640#sub311#
+$8645#sub312#
+$864A#sub313#
+$864F#sub314#
+$8654#sub315#
+$8659#sub316#
+$865E#sub317#
+$8663#sub318#
+$8668#sub319#
+$80CD#sub32#
+$866D#sub320#
+$8672#sub321#
+$8677#sub322#
+$867C#sub323#
+$8681#sub324#
+$8686#sub325#
+$868B#sub326#
+$8690#sub327#
+$8695#sub328#
+$869A#sub329#
+$80D2#sub33#
+$869F#sub330#
+$86A4#sub331#
+$86A9#sub332#
+$86AE#sub333#
+$86B3#sub334#
+$86B8#sub335#
+$86BD#sub336#
+$86C2#sub337#
+$86C7#sub338#
+$86CC#sub339#
+$80D7#sub34#
+$86D1#sub340#
+$86D6#sub341#
+$86DB#sub342#
+$86E0#sub343#
+$86E5#sub344#
+$86EA#sub345#
+$86EF#sub346#
+$86F4#sub347#
+$86F9#sub348#
+$86FE#sub349#
+$80DC#sub35#
+$8703#sub350#
+$8708#sub351#
+$870D#sub352#
+$8712#sub353#
+$8717#sub354#
+$871C#sub355#
+$8721#sub356#
+$8726#sub357#
+$872B#sub358#
+$8730#sub359#
+$80E1#sub36#
+$8735#sub360#
+$873A#sub361#
+$873F#sub362#
+$8744#sub363#
+$8749#sub364#
+$874E#sub365#
+$8753#sub366#
+$8758#sub367#
+$875D#sub368#
+$8762#sub369#
+$80E6#sub37#
+$8767#sub370#
+$876C#sub371#
+$8771#sub372#
+$8776#sub373#
+$877B#sub374#
+$8780#sub375#
+$8785#sub376#
+$878A#sub377#
+$878F#sub378#
+$8794#sub379#
+$80EB#sub38#
+$8799#sub380#
+$879E#sub381#
+$87A3#sub382#
+$87A8#sub383#
+$87AD#sub384#
+$87B2#sub385#
+$87B7#sub386#
+$87BC#sub387#
+$87C1#sub388#
+$87C6#sub389#
+$80F0#sub39#
+$87CB#sub390#
+$87D0#sub391#
+$87D5#sub392#
+$87DA#sub393#
+$87DF#sub394#
+$87E4#sub395#
+$87E9#sub396#
+$87EE#sub397#
+$87F3#sub398#
+$87F8#sub399#
+$8041#sub4#
+$80F5#sub40#
+$87FD#sub400#
+$8802#sub401#
+$8807#sub402#
+$880C#sub403#
+$8811#sub404#
+$8816#sub405#
+$881B#sub406#
+$8820#sub407#
+$8825#sub408#
+$882A#sub409#
+$80FA#sub41#
+$882F#sub410#
+$8834#sub411#
+$8839#sub412#
+$883E#sub413#
+$8843#sub414#
+$8848#sub415#
+$884D#sub416#
+$8852#sub417#
+$8857#sub418#
+$885C#sub419#
+$80FF#sub42#
+$8861#sub420#
+$8866#sub421#
+$886B#sub422#
+$8870#sub423#
+$8875#sub424#
+$887A#sub425#
+$887F#sub426#
+$8884#sub427#
+$8889#sub428#
+$888E#sub429#
+$8104#sub43#
+$8893#sub430#
+$8898#sub431#
+$889D#sub432#
+$88A2#sub433#
+$88A7#sub434#
+$88AC#sub435#
+$88B1#sub436#
+$88B6#sub437#
+$88BB#sub438#
+$88C0#sub439#
+$8109#sub44#
+$88C5#sub440#
+$88CA#sub441#
+$88CF#sub442#
+$88D4#sub443#
+$88D9#sub444#
+$88DE#sub445#
+$88E3#sub446#
+$88E8#sub447#
+$88ED#sub448#
+$88F2#sub449#
+$810E#sub45#
+$88F7#sub450#
+$88FC#sub451#
+$8901#sub452#
+$8906#sub453#
+$890B#sub454#
+$8910#sub455#
+$8915#sub456#
+$891A#sub457#
+$891F#sub458#
+$8924#sub459#
+$8113#sub46#
+$8929#sub460#
+$892E#sub461#
+$8933#sub462#
+$8938#sub463#
+$893D#sub464#
+$8942#sub465#
+$8947#sub466#
+$894C#sub467#
+$8951#sub468#
+$8956#sub469#
+$8118#sub47#
+$895B#sub470#
+$8960#sub471#
+$8965#sub472#
+$896A#sub473#
+$896F#sub474#
+$8974#sub475#
+$8979#sub476#
+$897E#sub477#
+$8983#sub478#
+$8988#sub479#
+$811D#sub48#
+$898D#sub480#
+$8992#sub481#
+$8997#sub482#
+$899C#sub483#
+$89A1#sub484#
+$89A6#sub485#
+$89AB#sub486#
+$89B0#sub487#
+$89B5#sub488#
+$89BA#sub489#
+$8122#sub49#
+$89BF#sub490#
+$89C4#sub491#
+$89C9#sub492#
+$89CE#sub493#
+$89D3#sub494#
+$89D8#sub495#
+$89DD#sub496#
+$89E2#sub497#
+$89E7#sub498#
+$89EC#sub499#
+$8046#sub5#
+$8127#sub50#
+$89F1#sub500#
+$89F6#sub501#
+$89FB#sub502#
+$8A00#sub503#
+$8A05#sub504#
+$8A0A#sub505#
+$8A0F#sub506#
+$8A14#sub507#
+$8A19#sub508#
+$8A1E#sub509#
+$812C#sub51#
+$8A23#sub510#
+$8A28#sub511#
+$8A2D#sub512#
+$8A32#sub513#
+$8A37#sub514#
+$8A3C#sub515#
+$8A41#sub516#
+$8A46#sub517#
+$8A4B#sub518#
+$8A50#sub519#
+$8131#sub52#
+$8A55#sub520#
+$8A5A#sub521#
+$8A5F#sub522#
+$8A64#sub523#
+$8A69#sub524#
+$8A6E#sub525#
+$8A73#sub526#
+$8A78#sub527#
+$8A7D#sub528#
+$8A82#sub529#
+$8136#sub53#
+$8A87#sub530#
+$8A8C#sub531#
+$8A91#sub532#
+$8A96#sub533#
+$8A9B#sub534#
+$8AA0#sub535#
+$8AA5#sub536#
+$8AAA#sub537#
+$8AAF#sub538#
+$8AB4#sub539#
+$813B#sub54#
+$8AB9#sub540#
+$8ABE#sub541#
+$8AC3#sub542#
+$8AC8#sub543#
+$8ACD#sub544#
+$8AD2#sub545#
+$8AD7#sub546#
+$8ADC#sub547#
+$8AE1#sub548#
+$8AE6#sub549#
+$8140#sub55#
+$8AEB#sub550#
+$8AF0#sub551#
+$8AF5#sub552#
+$8AFA#sub553#
+$8AFF#sub554#
+$8B04#sub555#
+$8B09#sub556#
+$8B0E#sub557#
+$8B13#sub558#
+$8B18#sub559#
+$8145#sub56#
+$8B1D#sub560#
+$8B22#sub561#
+$8B27#sub562#
+$8B2C#sub563#
+$8B31#sub564#
+$8B36#sub565#
+$8B3B#sub566#
+$8B40#sub567#
+$8B45#sub568#
+$8B4A#sub569#
+$814A#sub57#
+$8B4F#sub570#
+$8B54#sub571#
+$8B59#sub572#
+$8B5E#sub573#
+$8B63#sub574#
+$8B68#sub575#
+$8B6D#sub576#
+$8B72#sub577#
+$8B77#sub578#
+$8B7C#sub579#
+$814F#sub58#
+$8B81#sub580#
+$8B86#sub581#
+$8B8B#sub582#
+$8B90#sub583#
+$8B95#sub584#
+$8B9A#sub585#
+$8B9F#sub586#
+$8BA4#sub587#
+$8BA9#sub588#
+$8BAE#sub589#
+$8154#sub59#
+$8BB3#sub590#
+$8BB8#sub591#
+$8BBD#sub592#
+$8BC2#sub593#
+$8BC7#sub594#
+$8BCC#sub595#
+$8BD1#sub596#
+$8BD6#sub597#
+$8BDB#sub598#
+$8BE0#sub599#
+$804B#sub6#
+$8159#sub60#
+$815E#sub61#
+$8163#sub62#
+$8168#sub63#
+$816D#sub64#
+$8172#sub65#
+$8177#sub66#
+$817C#sub67#
+$8181#sub68#
+$8186#sub69#
+$8050#sub7#
+$818B#sub70#
+$8190#sub71#
+$8195#sub72#
+$819A#sub73#
+$819F#sub74#
+$81A4#sub75#
+$81A9#sub76#
+$81AE#sub77#
+$81B3#sub78#
+$81B8#sub79#
+$8055#sub8#
+$81BD#sub80#
+$81C2#sub81#
+$81C7#sub82#
+$81CC#sub83#
+$81D1#sub84#
+$81D6#sub85#
+$81DB#sub86#
+$81E0#sub87#
+$81E5#sub88#
+$81EA#sub89#
+$805A#sub9#
+$81EF#sub90#
+$81F4#sub91#
+$81F9#sub92#
+$81FE#sub93#
+$8203#sub94#
+$8208#sub95#
+$820D#sub96#
+$8212#sub97#
+$8217#sub98#
+$821C#sub99#
@@ -0,0 +1,1832 @@
+; the label tables grow and rehash several times here (600 labels, each
+; with a local @loop), and + - labels, locals and macro labels that share
+; names have to keep resolving to the right one
+
+	org $8000
+	jmp +
+	jmp ++
++	nop
+	jmp +
+++	nop
++	rts
+-	dex
+	bne -
+--	dey
+	bne --
+	bne -
+MACRO wait n
+	ldx #n
+-	dex
+	bne -
+	jmp +
++	nop
+ENDM
+first:
+	wait 1
+@a:	bne @a
+	wait 2
+second:
+@a:	beq @a
+	jmp first
+sub0:
+@loop:	bne @loop
+	jmp sub3
+sub1:
+@loop:	bne @loop
+	jmp sub10
+sub2:
+@loop:	bne @loop
+	jmp sub17
+sub3:
+@loop:	bne @loop
+	jmp sub24
+sub4:
+@loop:	bne @loop
+	jmp sub31
+sub5:
+@loop:	bne @loop
+	jmp sub38
+sub6:
+@loop:	bne @loop
+	jmp sub45
+sub7:
+@loop:	bne @loop
+	jmp sub52
+sub8:
+@loop:	bne @loop
+	jmp sub59
+sub9:
+@loop:	bne @loop
+	jmp sub66
+sub10:
+@loop:	bne @loop
+	jmp sub73
+sub11:
+@loop:	bne @loop
+	jmp sub80
+sub12:
+@loop:	bne @loop
+	jmp sub87
+sub13:
+@loop:	bne @loop
+	jmp sub94
+sub14:
+@loop:	bne @loop
+	jmp sub101
+sub15:
+@loop:	bne @loop
+	jmp sub108
+sub16:
+@loop:	bne @loop
+	jmp sub115
+sub17:
+@loop:	bne @loop
+	jmp sub122
+sub18:
+@loop:	bne @loop
+	jmp sub129
+sub19:
+@loop:	bne @loop
+	jmp sub136
+sub20:
+@loop:	bne @loop
+	jmp sub143
+sub21:
+@loop:	bne @loop
+	jmp sub150
+sub22:
+@loop:	bne @loop
+	jmp sub157
+sub23:
+@loop:	bne @loop
+	jmp sub164
+sub24:
+@loop:	bne @loop
+	jmp sub171
+sub25:
+@loop:	bne @loop
+	jmp sub178
+sub26:
+@loop:	bne @loop
+	jmp sub185
+sub27:
+@loop:	bne @loop
+	jmp sub192
+sub28:
+@loop:	bne @loop
+	jmp sub199
+sub29:
+@loop:	bne @loop
+	jmp sub206
+sub30:
+@loop:	bne @loop
+	jmp sub213
+sub31:
+@loop:	bne @loop
+	jmp sub220
+sub32:
+@loop:	bne @loop
+	jmp sub227
+sub33:
+@loop:	bne @loop
+	jmp sub234
+sub34:
+@loop:	bne @loop
+	jmp sub241
+sub35:
+@loop:	bne @loop
+	jmp sub248
+sub36:
+@loop:	bne @loop
+	jmp sub255
+sub37:
+@loop:	bne @loop
+	jmp sub262
+sub38:
+@loop:	bne @loop
+	jmp sub269
+sub39:
+@loop:	bne @loop
+	jmp sub276
+sub40:
+@loop:	bne @loop
+	jmp sub283
+sub41:
+@loop:	bne @loop
+	jmp sub290
+sub42:
+@loop:	bne @loop
+	jmp sub297
+sub43:
+@loop:	bne @loop
+	jmp sub304
+sub44:
+@loop:	bne @loop
+	jmp sub311
+sub45:
+@loop:	bne @loop
+	jmp sub318
+sub46:
+@loop:	bne @loop
+	jmp sub325
+sub47:
+@loop:	bne @loop
+	jmp sub332
+sub48:
+@loop:	bne @loop
+	jmp sub339
+sub49:
+@loop:	bne @loop
+	jmp sub346
+sub50:
+@loop:	bne @loop
+	jmp sub353
+sub51:
+@loop:	bne @loop
+	jmp sub360
+sub52:
+@loop:	bne @loop
+	jmp sub367
+sub53:
+@loop:	bne @loop
+	jmp sub374
+sub54:
+@loop:	bne @loop
+	jmp sub381
+sub55:
+@loop:	bne @loop
+	jmp sub388
+sub56:
+@loop:	bne @loop
+	jmp sub395
+sub57:
+@loop:	bne @loop
+	jmp sub402
+sub58:
+@loop:	bne @loop
+	jmp sub409
+sub59:
+@loop:	bne @loop
+	jmp sub416
+sub60:
+@loop:	bne @loop
+	jmp sub423
+sub61:
+@loop:	bne @loop
+	jmp sub430
+sub62:
+@loop:	bne @loop
+	jmp sub437
+sub63:
+@loop:	bne @loop
+	jmp sub444
+sub64:
+@loop:	bne @loop
+	jmp sub451
+sub65:
+@loop:	bne @loop
+	jmp sub458
+sub66:
+@loop:	bne @loop
+	jmp sub465
+sub67:
+@loop:	bne @loop
+	jmp sub472
+sub68:
+@loop:	bne @loop
+	jmp sub479
+sub69:
+@loop:	bne @loop
+	jmp sub486
+sub70:
+@loop:	bne @loop
+	jmp sub493
+sub71:
+@loop:	bne @loop
+	jmp sub500
+sub72:
+@loop:	bne @loop
+	jmp sub507
+sub73:
+@loop:	bne @loop
+	jmp sub514
+sub74:
+@loop:	bne @loop
+	jmp sub521
+sub75:
+@loop:	bne @loop
+	jmp sub528
+sub76:
+@loop:	bne @loop
+	jmp sub535
+sub77:
+@loop:	bne @loop
+	jmp sub542
+sub78:
+@loop:	bne @loop
+	jmp sub549
+sub79:
+@loop:	bne @loop
+	jmp sub556
+sub80:
+@loop:	bne @loop
+	jmp sub563
+sub81:
+@loop:	bne @loop
+	jmp sub570
+sub82:
+@loop:	bne @loop
+	jmp sub577
+sub83:
+@loop:	bne @loop
+	jmp sub584
+sub84:
+@loop:	bne @loop
+	jmp sub591
+sub85:
+@loop:	bne @loop
+	jmp sub598
+sub86:
+@loop:	bne @loop
+	jmp sub5
+sub87:
+@loop:	bne @loop
+	jmp sub12
+sub88:
+@loop:	bne @loop
+	jmp sub19
+sub89:
+@loop:	bne @loop
+	jmp sub26
+sub90:
+@loop:	bne @loop
+	jmp sub33
+sub91:
+@loop:	bne @loop
+	jmp sub40
+sub92:
+@loop:	bne @loop
+	jmp sub47
+sub93:
+@loop:	bne @loop
+	jmp sub54
+sub94:
+@loop:	bne @loop
+	jmp sub61
+sub95:
+@loop:	bne @loop
+	jmp sub68
+sub96:
+@loop:	bne @loop
+	jmp sub75
+sub97:
+@loop:	bne @loop
+	jmp sub82
+sub98:
+@loop:	bne @loop
+	jmp sub89
+sub99:
+@loop:	bne @loop
+	jmp sub96
+sub100:
+@loop:	bne @loop
+	jmp sub103
+sub101:
+@loop:	bne @loop
+	jmp sub110
+sub102:
+@loop:	bne @loop
+	jmp sub117
+sub103:
+@loop:	bne @loop
+	jmp sub124
+sub104:
+@loop:	bne @loop
+	jmp sub131
+sub105:
+@loop:	bne @loop
+	jmp sub138
+sub106:
+@loop:	bne @loop
+	jmp sub145
+sub107:
+@loop:	bne @loop
+	jmp sub152
+sub108:
+@loop:	bne @loop
+	jmp sub159
+sub109:
+@loop:	bne @loop
+	jmp sub166
+sub110:
+@loop:	bne @loop
+	jmp sub173
+sub111:
+@loop:	bne @loop
+	jmp sub180
+sub112:
+@loop:	bne @loop
+	jmp sub187
+sub113:
+@loop:	bne @loop
+	jmp sub194
+sub114:
+@loop:	bne @loop
+	jmp sub201
+sub115:
+@loop:	bne @loop
+	jmp sub208
+sub116:
+@loop:	bne @loop
+	jmp sub215
+sub117:
+@loop:	bne @loop
+	jmp sub222
+sub118:
+@loop:	bne @loop
+	jmp sub229
+sub119:
+@loop:	bne @loop
+	jmp sub236
+sub120:
+@loop:	bne @loop
+	jmp sub243
+sub121:
+@loop:	bne @loop
+	jmp sub250
+sub122:
+@loop:	bne @loop
+	jmp sub257
+sub123:
+@loop:	bne @loop
+	jmp sub264
+sub124:
+@loop:	bne @loop
+	jmp sub271
+sub125:
+@loop:	bne @loop
+	jmp sub278
+sub126:
+@loop:	bne @loop
+	jmp sub285
+sub127:
+@loop:	bne @loop
+	jmp sub292
+sub128:
+@loop:	bne @loop
+	jmp sub299
+sub129:
+@loop:	bne @loop
+	jmp sub306
+sub130:
+@loop:	bne @loop
+	jmp sub313
+sub131:
+@loop:	bne @loop
+	jmp sub320
+sub132:
+@loop:	bne @loop
+	jmp sub327
+sub133:
+@loop:	bne @loop
+	jmp sub334
+sub134:
+@loop:	bne @loop
+	jmp sub341
+sub135:
+@loop:	bne @loop
+	jmp sub348
+sub136:
+@loop:	bne @loop
+	jmp sub355
+sub137:
+@loop:	bne @loop
+	jmp sub362
+sub138:
+@loop:	bne @loop
+	jmp sub369
+sub139:
+@loop:	bne @loop
+	jmp sub376
+sub140:
+@loop:	bne @loop
+	jmp sub383
+sub141:
+@loop:	bne @loop
+	jmp sub390
+sub142:
+@loop:	bne @loop
+	jmp sub397
+sub143:
+@loop:	bne @loop
+	jmp sub404
+sub144:
+@loop:	bne @loop
+	jmp sub411
+sub145:
+@loop:	bne @loop
+	jmp sub418
+sub146:
+@loop:	bne @loop
+	jmp sub425
+sub147:
+@loop:	bne @loop
+	jmp sub432
+sub148:
+@loop:	bne @loop
+	jmp sub439
+sub149:
+@loop:	bne @loop
+	jmp sub446
+sub150:
+@loop:	bne @loop
+	jmp sub453
+sub151:
+@loop:	bne @loop
+	jmp sub460
+sub152:
+@loop:	bne @loop
+	jmp sub467
+sub153:
+@loop:	bne @loop
+	jmp sub474
+sub154:
+@loop:	bne @loop
+	jmp sub481
+sub155:
+@loop:	bne @loop
+	jmp sub488
+sub156:
+@loop:	bne @loop
+	jmp sub495
+sub157:
+@loop:	bne @loop
+	jmp sub502
+sub158:
+@loop:	bne @loop
+	jmp sub509
+sub159:
+@loop:	bne @loop
+	jmp sub516
+sub160:
+@loop:	bne @loop
+	jmp sub523
+sub161:
+@loop:	bne @loop
+	jmp sub530
+sub162:
+@loop:	bne @loop
+	jmp sub537
+sub163:
+@loop:	bne @loop
+	jmp sub544
+sub164:
+@loop:	bne @loop
+	jmp sub551
+sub165:
+@loop:	bne @loop
+	jmp sub558
+sub166:
+@loop:	bne @loop
+	jmp sub565
+sub167:
+@loop:	bne @loop
+	jmp sub572
+sub168:
+@loop:	bne @loop
+	jmp sub579
+sub169:
+@loop:	bne @loop
+	jmp sub586
+sub170:
+@loop:	bne @loop
+	jmp sub593
+sub171:
+@loop:	bne @loop
+	jmp sub0
+sub172:
+@loop:	bne @loop
+	jmp sub7
+sub173:
+@loop:	bne @loop
+	jmp sub14
+sub174:
+@loop:	bne @loop
+	jmp sub21
+sub175:
+@loop:	bne @loop
+	jmp sub28
+sub176:
+@loop:	bne @loop
+	jmp sub35
+sub177:
+@loop:	bne @loop
+	jmp sub42
+sub178:
+@loop:	bne @loop
+	jmp sub49
+sub179:
+@loop:	bne @loop
+	jmp sub56
+sub180:
+@loop:	bne @loop
+	jmp sub63
+sub181:
+@loop:	bne @loop
+	jmp sub70
+sub182:
+@loop:	bne @loop
+	jmp sub77
+sub183:
+@loop:	bne @loop
+	jmp sub84
+sub184:
+@loop:	bne @loop
+	jmp sub91
+sub185:
+@loop:	bne @loop
+	jmp sub98
+sub186:
+@loop:	bne @loop
+	jmp sub105
+sub187:
+@loop:	bne @loop
+	jmp sub112
+sub188:
+@loop:	bne @loop
+	jmp sub119
+sub189:
+@loop:	bne @loop
+	jmp sub126
+sub190:
+@loop:	bne @loop
+	jmp sub133
+sub191:
+@loop:	bne @loop
+	jmp sub140
+sub192:
+@loop:	bne @loop
+	jmp sub147
+sub193:
+@loop:	bne @loop
+	jmp sub154
+sub194:
+@loop:	bne @loop
+	jmp sub161
+sub195:
+@loop:	bne @loop
+	jmp sub168
+sub196:
+@loop:	bne @loop
+	jmp sub175
+sub197:
+@loop:	bne @loop
+	jmp sub182
+sub198:
+@loop:	bne @loop
+	jmp sub189
+sub199:
+@loop:	bne @loop
+	jmp sub196
+sub200:
+@loop:	bne @loop
+	jmp sub203
+sub201:
+@loop:	bne @loop
+	jmp sub210
+sub202:
+@loop:	bne @loop
+	jmp sub217
+sub203:
+@loop:	bne @loop
+	jmp sub224
+sub204:
+@loop:	bne @loop
+	jmp sub231
+sub205:
+@loop:	bne @loop
+	jmp sub238
+sub206:
+@loop:	bne @loop
+	jmp sub245
+sub207:
+@loop:	bne @loop
+	jmp sub252
+sub208:
+@loop:	bne @loop
+	jmp sub259
+sub209:
+@loop:	bne @loop
+	jmp sub266
+sub210:
+@loop:	bne @loop
+	jmp sub273
+sub211:
+@loop:	bne @loop
+	jmp sub280
+sub212:
+@loop:	bne @loop
+	jmp sub287
+sub213:
+@loop:	bne @loop
+	jmp sub294
+sub214:
+@loop:	bne @loop
+	jmp sub301
+sub215:
+@loop:	bne @loop
+	jmp sub308
+sub216:
+@loop:	bne @loop
+	jmp sub315
+sub217:
+@loop:	bne @loop
+	jmp sub322
+sub218:
+@loop:	bne @loop
+	jmp sub329
+sub219:
+@loop:	bne @loop
+	jmp sub336
+sub220:
+@loop:	bne @loop
+	jmp sub343
+sub221:
+@loop:	bne @loop
+	jmp sub350
+sub222:
+@loop:	bne @loop
+	jmp sub357
+sub223:
+@loop:	bne @loop
+	jmp sub364
+sub224:
+@loop:	bne @loop
+	jmp sub371
+sub225:
+@loop:	bne @loop
+	jmp sub378
+sub226:
+@loop:	bne @loop
+	jmp sub385
+sub227:
+@loop:	bne @loop
+	jmp sub392
+sub228:
+@loop:	bne @loop
+	jmp sub399
+sub229:
+@loop:	bne @loop
+	jmp sub406
+sub230:
+@loop:	bne @loop
+	jmp sub413
+sub231:
+@loop:	bne @loop
+	jmp sub420
+sub232:
+@loop:	bne @loop
+	jmp sub427
+sub233:
+@loop:	bne @loop
+	jmp sub434
+sub234:
+@loop:	bne @loop
+	jmp sub441
+sub235:
+@loop:	bne @loop
+	jmp sub448
+sub236:
+@loop:	bne @loop
+	jmp sub455
+sub237:
+@loop:	bne @loop
+	jmp sub462
+sub238:
+@loop:	bne @loop
+	jmp sub469
+sub239:
+@loop:	bne @loop
+	jmp sub476
+sub240:
+@loop:	bne @loop
+	jmp sub483
+sub241:
+@loop:	bne @loop
+	jmp sub490
+sub242:
+@loop:	bne @loop
+	jmp sub497
+sub243:
+@loop:	bne @loop
+	jmp sub504
+sub244:
+@loop:	bne @loop
+	jmp sub511
+sub245:
+@loop:	bne @loop
+	jmp sub518
+sub246:
+@loop:	bne @loop
+	jmp sub525
+sub247:
+@loop:	bne @loop
+	jmp sub532
+sub248:
+@loop:	bne @loop
+	jmp sub539
+sub249:
+@loop:	bne @loop
+	jmp sub546
+sub250:
+@loop:	bne @loop
+	jmp sub553
+sub251:
+@loop:	bne @loop
+	jmp sub560
+sub252:
+@loop:	bne @loop
+	jmp sub567
+sub253:
+@loop:	bne @loop
+	jmp sub574
+sub254:
+@loop:	bne @loop
+	jmp sub581
+sub255:
+@loop:	bne @loop
+	jmp sub588
+sub256:
+@loop:	bne @loop
+	jmp sub595
+sub257:
+@loop:	bne @loop
+	jmp sub2
+sub258:
+@loop:	bne @loop
+	jmp sub9
+sub259:
+@loop:	bne @loop
+	jmp sub16
+sub260:
+@loop:	bne @loop
+	jmp sub23
+sub261:
+@loop:	bne @loop
+	jmp sub30
+sub262:
+@loop:	bne @loop
+	jmp sub37
+sub263:
+@loop:	bne @loop
+	jmp sub44
+sub264:
+@loop:	bne @loop
+	jmp sub51
+sub265:
+@loop:	bne @loop
+	jmp sub58
+sub266:
+@loop:	bne @loop
+	jmp sub65
+sub267:
+@loop:	bne @loop
+	jmp sub72
+sub268:
+@loop:	bne @loop
+	jmp sub79
+sub269:
+@loop:	bne @loop
+	jmp sub86
+sub270:
+@loop:	bne @loop
+	jmp sub93
+sub271:
+@loop:	bne @loop
+	jmp sub100
+sub272:
+@loop:	bne @loop
+	jmp sub107
+sub273:
+@loop:	bne @loop
+	jmp sub114
+sub274:
+@loop:	bne @loop
+	jmp sub121
+sub275:
+@loop:	bne @loop
+	jmp sub128
+sub276:
+@loop:	bne @loop
+	jmp sub135
+sub277:
+@loop:	bne @loop
+	jmp sub142
+sub278:
+@loop:	bne @loop
+	jmp sub149
+sub279:
+@loop:	bne @loop
+	jmp sub156
+sub280:
+@loop:	bne @loop
+	jmp sub163
+sub281:
+@loop:	bne @loop
+	jmp sub170
+sub282:
+@loop:	bne @loop
+	jmp sub177
+sub283:
+@loop:	bne @loop
+	jmp sub184
+sub284:
+@loop:	bne @loop
+	jmp sub191
+sub285:
+@loop:	bne @loop
+	jmp sub198
+sub286:
+@loop:	bne @loop
+	jmp sub205
+sub287:
+@loop:	bne @loop
+	jmp sub212
+sub288:
+@loop:	bne @loop
+	jmp sub219
+sub289:
+@loop:	bne @loop
+	jmp sub226
+sub290:
+@loop:	bne @loop
+	jmp sub233
+sub291:
+@loop:	bne @loop
+	jmp sub240
+sub292:
+@loop:	bne @loop
+	jmp sub247
+sub293:
+@loop:	bne @loop
+	jmp sub254
+sub294:
+@loop:	bne @loop
+	jmp sub261
+sub295:
+@loop:	bne @loop
+	jmp sub268
+sub296:
+@loop:	bne @loop
+	jmp sub275
+sub297:
+@loop:	bne @loop
+	jmp sub282
+sub298:
+@loop:	bne @loop
+	jmp sub289
+sub299:
+@loop:	bne @loop
+	jmp sub296
+sub300:
+@loop:	bne @loop
+	jmp sub303
+sub301:
+@loop:	bne @loop
+	jmp sub310
+sub302:
+@loop:	bne @loop
+	jmp sub317
+sub303:
+@loop:	bne @loop
+	jmp sub324
+sub304:
+@loop:	bne @loop
+	jmp sub331
+sub305:
+@loop:	bne @loop
+	jmp sub338
+sub306:
+@loop:	bne @loop
+	jmp sub345
+sub307:
+@loop:	bne @loop
+	jmp sub352
+sub308:
+@loop:	bne @loop
+	jmp sub359
+sub309:
+@loop:	bne @loop
+	jmp sub366
+sub310:
+@loop:	bne @loop
+	jmp sub373
+sub311:
+@loop:	bne @loop
+	jmp sub380
+sub312:
+@loop:	bne @loop
+	jmp sub387
+sub313:
+@loop:	bne @loop
+	jmp sub394
+sub314:
+@loop:	bne @loop
+	jmp sub401
+sub315:
+@loop:	bne @loop
+	jmp sub408
+sub316:
+@loop:	bne @loop
+	jmp sub415
+sub317:
+@loop:	bne @loop
+	jmp sub422
+sub318:
+@loop:	bne @loop
+	jmp sub429
+sub319:
+@loop:	bne @loop
+	jmp sub436
+sub320:
+@loop:	bne @loop
+	jmp sub443
+sub321:
+@loop:	bne @loop
+	jmp sub450
+sub322:
+@loop:	bne @loop
+	jmp sub457
+sub323:
+@loop:	bne @loop
+	jmp sub464
+sub324:
+@loop:	bne @loop
+	jmp sub471
+sub325:
+@loop:	bne @loop
+	jmp sub478
+sub326:
+@loop:	bne @loop
+	jmp sub485
+sub327:
+@loop:	bne @loop
+	jmp sub492
+sub328:
+@loop:	bne @loop
+	jmp sub499
+sub329:
+@loop:	bne @loop
+	jmp sub506
+sub330:
+@loop:	bne @loop
+	jmp sub513
+sub331:
+@loop:	bne @loop
+	jmp sub520
+sub332:
+@loop:	bne @loop
+	jmp sub527
+sub333:
+@loop:	bne @loop
+	jmp sub534
+sub334:
+@loop:	bne @loop
+	jmp sub541
+sub335:
+@loop:	bne @loop
+	jmp sub548
+sub336:
+@loop:	bne @loop
+	jmp sub555
+sub337:
+@loop:	bne @loop
+	jmp sub562
+sub338:
+@loop:	bne @loop
+	jmp sub569
+sub339:
+@loop:	bne @loop
+	jmp sub576
+sub340:
+@loop:	bne @loop
+	jmp sub583
+sub341:
+@loop:	bne @loop
+	jmp sub590
+sub342:
+@loop:	bne @loop
+	jmp sub597
+sub343:
+@loop:	bne @loop
+	jmp sub4
+sub344:
+@loop:	bne @loop
+	jmp sub11
+sub345:
+@loop:	bne @loop
+	jmp sub18
+sub346:
+@loop:	bne @loop
+	jmp sub25
+sub347:
+@loop:	bne @loop
+	jmp sub32
+sub348:
+@loop:	bne @loop
+	jmp sub39
+sub349:
+@loop:	bne @loop
+	jmp sub46
+sub350:
+@loop:	bne @loop
+	jmp sub53
+sub351:
+@loop:	bne @loop
+	jmp sub60
+sub352:
+@loop:	bne @loop
+	jmp sub67
+sub353:
+@loop:	bne @loop
+	jmp sub74
+sub354:
+@loop:	bne @loop
+	jmp sub81
+sub355:
+@loop:	bne @loop
+	jmp sub88
+sub356:
+@loop:	bne @loop
+	jmp sub95
+sub357:
+@loop:	bne @loop
+	jmp sub102
+sub358:
+@loop:	bne @loop
+	jmp sub109
+sub359:
+@loop:	bne @loop
+	jmp sub116
+sub360:
+@loop:	bne @loop
+	jmp sub123
+sub361:
+@loop:	bne @loop
+	jmp sub130
+sub362:
+@loop:	bne @loop
+	jmp sub137
+sub363:
+@loop:	bne @loop
+	jmp sub144
+sub364:
+@loop:	bne @loop
+	jmp sub151
+sub365:
+@loop:	bne @loop
+	jmp sub158
+sub366:
+@loop:	bne @loop
+	jmp sub165
+sub367:
+@loop:	bne @loop
+	jmp sub172
+sub368:
+@loop:	bne @loop
+	jmp sub179
+sub369:
+@loop:	bne @loop
+	jmp sub186
+sub370:
+@loop:	bne @loop
+	jmp sub193
+sub371:
+@loop:	bne @loop
+	jmp sub200
+sub372:
+@loop:	bne @loop
+	jmp sub207
+sub373:
+@loop:	bne @loop
+	jmp sub214
+sub374:
+@loop:	bne @loop
+	jmp sub221
+sub375:
+@loop:	bne @loop
+	jmp sub228
+sub376:
+@loop:	bne @loop
+	jmp sub235
+sub377:
+@loop:	bne @loop
+	jmp sub242
+sub378:
+@loop:	bne @loop
+	jmp sub249
+sub379:
+@loop:	bne @loop
+	jmp sub256
+sub380:
+@loop:	bne @loop
+	jmp sub263
+sub381:
+@loop:	bne @loop
+	jmp sub270
+sub382:
+@loop:	bne @loop
+	jmp sub277
+sub383:
+@loop:	bne @loop
+	jmp sub284
+sub384:
+@loop:	bne @loop
+	jmp sub291
+sub385:
+@loop:	bne @loop
+	jmp sub298
+sub386:
+@loop:	bne @loop
+	jmp sub305
+sub387:
+@loop:	bne @loop
+	jmp sub312
+sub388:
+@loop:	bne @loop
+	jmp sub319
+sub389:
+@loop:	bne @loop
+	jmp sub326
+sub390:
+@loop:	bne @loop
+	jmp sub333
+sub391:
+@loop:	bne @loop
+	jmp sub340
+sub392:
+@loop:	bne @loop
+	jmp sub347
+sub393:
+@loop:	bne @loop
+	jmp sub354
+sub394:
+@loop:	bne @loop
+	jmp sub361
+sub395:
+@loop:	bne @loop
+	jmp sub368
+sub396:
+@loop:	bne @loop
+	jmp sub375
+sub397:
+@loop:	bne @loop
+	jmp sub382
+sub398:
+@loop:	bne @loop
+	jmp sub389
+sub399:
+@loop:	bne @loop
+	jmp sub396
+sub400:
+@loop:	bne @loop
+	jmp sub403
+sub401:
+@loop:	bne @loop
+	jmp sub410
+sub402:
+@loop:	bne @loop
+	jmp sub417
+sub403:
+@loop:	bne @loop
+	jmp sub424
+sub404:
+@loop:	bne @loop
+	jmp sub431
+sub405:
+@loop:	bne @loop
+	jmp sub438
+sub406:
+@loop:	bne @loop
+	jmp sub445
+sub407:
+@loop:	bne @loop
+	jmp sub452
+sub408:
+@loop:	bne @loop
+	jmp sub459
+sub409:
+@loop:	bne @loop
+	jmp sub466
+sub410:
+@loop:	bne @loop
+	jmp sub473
+sub411:
+@loop:	bne @loop
+	jmp sub480
+sub412:
+@loop:	bne @loop
+	jmp sub487
+sub413:
+@loop:	bne @loop
+	jmp sub494
+sub414:
+@loop:	bne @loop
+	jmp sub501
+sub415:
+@loop:	bne @loop
+	jmp sub508
+sub416:
+@loop:	bne @loop
+	jmp sub515
+sub417:
+@loop:	bne @loop
+	jmp sub522
+sub418:
+@loop:	bne @loop
+	jmp sub529
+sub419:
+@loop:	bne @loop
+	jmp sub536
+sub420:
+@loop:	bne @loop
+	jmp sub543
+sub421:
+@loop:	bne @loop
+	jmp sub550
+sub422:
+@loop:	bne @loop
+	jmp sub557
+sub423:
+@loop:	bne @loop
+	jmp sub564
+sub424:
+@loop:	bne @loop
+	jmp sub571
+sub425:
+@loop:	bne @loop
+	jmp sub578
+sub426:
+@loop:	bne @loop
+	jmp sub585
+sub427:
+@loop:	bne @loop
+	jmp sub592
+sub428:
+@loop:	bne @loop
+	jmp sub599
+sub429:
+@loop:	bne @loop
+	jmp sub6
+sub430:
+@loop:	bne @loop
+	jmp sub13
+sub431:
+@loop:	bne @loop
+	jmp sub20
+sub432:
+@loop:	bne @loop
+	jmp sub27
+sub433:
+@loop:	bne @loop
+	jmp sub34
+sub434:
+@loop:	bne @loop
+	jmp sub41
+sub435:
+@loop:	bne @loop
+	jmp sub48
+sub436:
+@loop:	bne @loop
+	jmp sub55
+sub437:
+@loop:	bne @loop
+	jmp sub62
+sub438:
+@loop:	bne @loop
+	jmp sub69
+sub439:
+@loop:	bne @loop
+	jmp sub76
+sub440:
+@loop:	bne @loop
+	jmp sub83
+sub441:
+@loop:	bne @loop
+	jmp sub90
+sub442:
+@loop:	bne @loop
+	jmp sub97
+sub443:
+@loop:	bne @loop
+	jmp sub104
+sub444:
+@loop:	bne @loop
+	jmp sub111
+sub445:
+@loop:	bne @loop
+	jmp sub118
+sub446:
+@loop:	bne @loop
+	jmp sub125
+sub447:
+@loop:	bne @loop
+	jmp sub132
+sub448:
+@loop:	bne @loop
+	jmp sub139
+sub449:
+@loop:	bne @loop
+	jmp sub146
+sub450:
+@loop:	bne @loop
+	jmp sub153
+sub451:
+@loop:	bne @loop
+	jmp sub160
+sub452:
+@loop:	bne @loop
+	jmp sub167
+sub453:
+@loop:	bne @loop
+	jmp sub174
+sub454:
+@loop:	bne @loop
+	jmp sub181
+sub455:
+@loop:	bne @loop
+	jmp sub188
+sub456:
+@loop:	bne @loop
+	jmp sub195
+sub457:
+@loop:	bne @loop
+	jmp sub202
+sub458:
+@loop:	bne @loop
+	jmp sub209
+sub459:
+@loop:	bne @loop
+	jmp sub216
+sub460:
+@loop:	bne @loop
+	jmp sub223
+sub461:
+@loop:	bne @loop
+	jmp sub230
+sub462:
+@loop:	bne @loop
+	jmp sub237
+sub463:
+@loop:	bne @loop
+	jmp sub244
+sub464:
+@loop:	bne @loop
+	jmp sub251
+sub465:
+@loop:	bne @loop
+	jmp sub258
+sub466:
+@loop:	bne @loop
+	jmp sub265
+sub467:
+@loop:	bne @loop
+	jmp sub272
+sub468:
+@loop:	bne @loop
+	jmp sub279
+sub469:
+@loop:	bne @loop
+	jmp sub286
+sub470:
+@loop:	bne @loop
+	jmp sub293
+sub471:
+@loop:	bne @loop
+	jmp sub300
+sub472:
+@loop:	bne @loop
+	jmp sub307
+sub473:
+@loop:	bne @loop
+	jmp sub314
+sub474:
+@loop:	bne @loop
+	jmp sub321
+sub475:
+@loop:	bne @loop
+	jmp sub328
+sub476:
+@loop:	bne @loop
+	jmp sub335
+sub477:
+@loop:	bne @loop
+	jmp sub342
+sub478:
+@loop:	bne @loop
+	jmp sub349
+sub479:
+@loop:	bne @loop
+	jmp sub356
+sub480:
+@loop:	bne @loop
+	jmp sub363
+sub481:
+@loop:	bne @loop
+	jmp sub370
+sub482:
+@loop:	bne @loop
+	jmp sub377
+sub483:
+@loop:	bne @loop
+	jmp sub384
+sub484:
+@loop:	bne @loop
+	jmp sub391
+sub485:
+@loop:	bne @loop
+	jmp sub398
+sub486:
+@loop:	bne @loop
+	jmp sub405
+sub487:
+@loop:	bne @loop
+	jmp sub412
+sub488:
+@loop:	bne @loop
+	jmp sub419
+sub489:
+@loop:	bne @loop
+	jmp sub426
+sub490:
+@loop:	bne @loop
+	jmp sub433
+sub491:
+@loop:	bne @loop
+	jmp sub440
+sub492:
+@loop:	bne @loop
+	jmp sub447
+sub493:
+@loop:	bne @loop
+	jmp sub454
+sub494:
+@loop:	bne @loop
+	jmp sub461
+sub495:
+@loop:	bne @loop
+	jmp sub468
+sub496:
+@loop:	bne @loop
+	jmp sub475
+sub497:
+@loop:	bne @loop
+	jmp sub482
+sub498:
+@loop:	bne @loop
+	jmp sub489
+sub499:
+@loop:	bne @loop
+	jmp sub496
+sub500:
+@loop:	bne @loop
+	jmp sub503
+sub501:
+@loop:	bne @loop
+	jmp sub510
+sub502:
+@loop:	bne @loop
+	jmp sub517
+sub503:
+@loop:	bne @loop
+	jmp sub524
+sub504:
+@loop:	bne @loop
+	jmp sub531
+sub505:
+@loop:	bne @loop
+	jmp sub538
+sub506:
+@loop:	bne @loop
+	jmp sub545
+sub507:
+@loop:	bne @loop
+	jmp sub552
+sub508:
+@loop:	bne @loop
+	jmp sub559
+sub509:
+@loop:	bne @loop
+	jmp sub566
+sub510:
+@loop:	bne @loop
+	jmp sub573
+sub511:
+@loop:	bne @loop
+	jmp sub580
+sub512:
+@loop:	bne @loop
+	jmp sub587
+sub513:
+@loop:	bne @loop
+	jmp sub594
+sub514:
+@loop:	bne @loop
+	jmp sub1
+sub515:
+@loop:	bne @loop
+	jmp sub8
+sub516:
+@loop:	bne @loop
+	jmp sub15
+sub517:
+@loop:	bne @loop
+	jmp sub22
+sub518:
+@loop:	bne @loop
+	jmp sub29
+sub519:
+@loop:	bne @loop
+	jmp sub36
+sub520:
+@loop:	bne @loop
+	jmp sub43
+sub521:
+@loop:	bne @loop
+	jmp sub50
+sub522:
+@loop:	bne @loop
+	jmp sub57
+sub523:
+@loop:	bne @loop
+	jmp sub64
+sub524:
+@loop:	bne @loop
+	jmp sub71
+sub525:
+@loop:	bne @loop
+	jmp sub78
+sub526:
+@loop:	bne @loop
+	jmp sub85
+sub527:
+@loop:	bne @loop
+	jmp sub92
+sub528:
+@loop:	bne @loop
+	jmp sub99
+sub529:
+@loop:	bne @loop
+	jmp sub106
+sub530:
+@loop:	bne @loop
+	jmp sub113
+sub531:
+@loop:	bne @loop
+	jmp sub120
+sub532:
+@loop:	bne @loop
+	jmp sub127
+sub533:
+@loop:	bne @loop
+	jmp sub134
+sub534:
+@loop:	bne @loop
+	jmp sub141
+sub535:
+@loop:	bne @loop
+	jmp sub148
+sub536:
+@loop:	bne @loop
+	jmp sub155
+sub537:
+@loop:	bne @loop
+	jmp sub162
+sub538:
+@loop:	bne @loop
+	jmp sub169
+sub539:
+@loop:	bne @loop
+	jmp sub176
+sub540:
+@loop:	bne @loop
+	jmp sub183
+sub541:
+@loop:	bne @loop
+	jmp sub190
+sub542:
+@loop:	bne @loop
+	jmp sub197
+sub543:
+@loop:	bne @loop
+	jmp sub204
+sub544:
+@loop:	bne @loop
+	jmp sub211
+sub545:
+@loop:	bne @loop
+	jmp sub218
+sub546:
+@loop:	bne @loop
+	jmp sub225
+sub547:
+@loop:	bne @loop
+	jmp sub232
+sub548:
+@loop:	bne @loop
+	jmp sub239
+sub549:
+@loop:	bne @loop
+	jmp sub246
+sub550:
+@loop:	bne @loop
+	jmp sub253
+sub551:
+@loop:	bne @loop
+	jmp sub260
+sub552:
+@loop:	bne @loop
+	jmp sub267
+sub553:
+@loop:	bne @loop
+	jmp sub274
+sub554:
+@loop:	bne @loop
+	jmp sub281
+sub555:
+@loop:	bne @loop
+	jmp sub288
+sub556:
+@loop:	bne @loop
+	jmp sub295
+sub557:
+@loop:	bne @loop
+	jmp sub302
+sub558:
+@loop:	bne @loop
+	jmp sub309
+sub559:
+@loop:	bne @loop
+	jmp sub316
+sub560:
+@loop:	bne @loop
+	jmp sub323
+sub561:
+@loop:	bne @loop
+	jmp sub330
+sub562:
+@loop:	bne @loop
+	jmp sub337
+sub563:
+@loop:	bne @loop
+	jmp sub344
+sub564:
+@loop:	bne @loop
+	jmp sub351
+sub565:
+@loop:	bne @loop
+	jmp sub358
+sub566:
+@loop:	bne @loop
+	jmp sub365
+sub567:
+@loop:	bne @loop
+	jmp sub372
+sub568:
+@loop:	bne @loop
+	jmp sub379
+sub569:
+@loop:	bne @loop
+	jmp sub386
+sub570:
+@loop:	bne @loop
+	jmp sub393
+sub571:
+@loop:	bne @loop
+	jmp sub400
+sub572:
+@loop:	bne @loop
+	jmp sub407
+sub573:
+@loop:	bne @loop
+	jmp sub414
+sub574:
+@loop:	bne @loop
+	jmp sub421
+sub575:
+@loop:	bne @loop
+	jmp sub428
+sub576:
+@loop:	bne @loop
+	jmp sub435
+sub577:
+@loop:	bne @loop
+	jmp sub442
+sub578:
+@loop:	bne @loop
+	jmp sub449
+sub579:
+@loop:	bne @loop
+	jmp sub456
+sub580:
+@loop:	bne @loop
+	jmp sub463
+sub581:
+@loop:	bne @loop
+	jmp sub470
+sub582:
+@loop:	bne @loop
+	jmp sub477
+sub583:
+@loop:	bne @loop
+	jmp sub484
+sub584:
+@loop:	bne @loop
+	jmp sub491
+sub585:
+@loop:	bne @loop
+	jmp sub498
+sub586:
+@loop:	bne @loop
+	jmp sub505
+sub587:
+@loop:	bne @loop
+	jmp sub512
+sub588:
+@loop:	bne @loop
+	jmp sub519
+sub589:
+@loop:	bne @loop
+	jmp sub526
+sub590:
+@loop:	bne @loop
+	jmp sub533
+sub591:
+@loop:	bne @loop
+	jmp sub540
+sub592:
+@loop:	bne @loop
+	jmp sub547
+sub593:
+@loop:	bne @loop
+	jmp sub554
+sub594:
+@loop:	bne @loop
+	jmp sub561
+sub595:
+@loop:	bne @loop
+	jmp sub568
+sub596:
+@loop:	bne @loop
+	jmp sub575
+sub597:
+@loop:	bne @loop
+	jmp sub582
+sub598:
+@loop:	bne @loop
+	jmp sub589
+sub599:
+@loop:	bne @loop
+	jmp sub596
+last:
+	dw sub0, sub599, sub300, last
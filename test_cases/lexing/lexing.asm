@@ -0,0 +1,26 @@
+; lines are lexed once and rebuilt from the tokens on later passes. these
+; are the cases the lexer has to scan the same way expandline() does
+
+SIZE EQU 4
+DOUBLE EQU SIZE*2
+	org $8000
+	.db SIZE, DOUBLE		; EQU is expanded, IFDEF's symbol is not
+ifdef SIZE
+	db 1
+endif
+ifndef DOUBLE
+	db 0
+else
+	db 2
+endif
+	db "a;b", ';', 'x'	; quotes hide ; and symbols
+	db "say \"hi\" SIZE"
+	db $0a, 10, %101, 0fh, 1010b
+	LDA #SIZE
+	sta $0010
+	lda fwd,x
+fwd = $20
+next:
+	.dw next, @here
+@here:
+	rts ;comment with SIZE
@@ -0,0 +1,88 @@
+// assembles through asm6f.h (see "make test") and checks what comes back
+
+#include <stdio.h>
+#include <string.h>
+#include "asm6f.h"
+
+static const char mainsrc[]=
+	"\torg $8000\n"
+	"E equ 3+4\n"
+	"ifdef FAST\n"
+	"\tlda #E\n"
+	"endif\n"
+	"start:\tjsr sub\n"
+	"\tjmp start\n"
+	"\tinclude sub.asm\n";
+static const char subsrc[]="sub:\tlda #5\n\trts\n";
+static const char badsrc[]="\torg $8000\n\tlda nothere\n";
+
+static int failures=0;
+static int nested=-2;
+
+static void check(int ok,const char *what) {
+	if(!ok) {
+		printf("FAIL: library: %s\n",what);
+		failures++;
+	}
+}
+
+static int readfile(void *user,const char *name,const void **data,long *size) {
+	asm6f_options o={0};
+	asm6f_result r;
+	if(strcmp(name,"sub.asm"))
+		return 0;
+	o.source="sub.asm";
+	nested=asm6f_assemble(&o,&r);//(not allowed, the outer one is running)
+	asm6f_free(&r);
+	*data=subsrc;
+	*size=strlen(subsrc);
+	return 1;
+}
+
+static const asm6f_symbol *symbol(const asm6f_result *r,const char *name) {
+	int i;
+	for(i=0;i<r->symbolcount;i++)
+		if(!strcmp(r->symbols[i].name,name))
+			return &r->symbols[i];
+	return 0;
+}
+
+int main(void) {
+	static const unsigned char fast[]={0xa9,0x07,0x20,0x08,0x80,0x4c,0x02,0x80,0xa9,0x05,0x60};
+	const char *defines[]={"FAST",0};
+	asm6f_file files[]={{"main.asm",mainsrc,0},{"bad.asm",badsrc,0}};
+	asm6f_options o={0};
+	asm6f_result r;
+	const asm6f_symbol *s;
+
+	files[0].size=strlen(mainsrc);
+	files[1].size=strlen(badsrc);
+	o.files=files;
+	o.filecount=2;
+	o.read=readfile;
+
+	o.source="main.asm";
+	o.defines=defines;
+	check(asm6f_assemble(&o,&r)==0,"main.asm assembles");
+	check(r.romsize==sizeof(fast) && !memcmp(r.rom,fast,sizeof(fast)),"main.asm image");
+	check((s=symbol(&r,"sub")) && s->type==ASM6F_LABEL && s->value==0x8008 && s->offset==8,"label sub");
+	check((s=symbol(&r,"E")) && s->type==ASM6F_EQUATE && !strcmp(s->text,"3+4"),"equate E");
+	check((s=symbol(&r,"FAST")) && s->type==ASM6F_VALUE && s->value==1,"define FAST");
+	check(!*r.diagnostics,"no diagnostics");
+	check(nested==-1,"a call from the read callback fails");
+	asm6f_free(&r);
+
+	o.source="bad.asm";
+	o.defines=0;
+	check(asm6f_assemble(&o,&r)==-1 && r.errors && !r.rom,"bad.asm fails");
+	check(strstr(r.diagnostics,"bad.asm(2)")!=0,"bad.asm diagnostic");
+	asm6f_free(&r);
+
+	o.source="main.asm";
+	check(asm6f_assemble(&o,&r)==0 && r.romsize==sizeof(fast)-2 && !symbol(&r,"FAST"),"main.asm again, without FAST");
+	asm6f_free(&r);
+
+	if(!failures)
+		printf("library test passed\n");
+	return failures!=0;
+}
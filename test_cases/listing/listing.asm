@@ -0,0 +1,24 @@
+; the listing only shows the last pass, and the lines after "lda far" move
+; between passes. long data lines show their first bytes, a macro is one
+; line, a REPT's bytes go on its ENDR and skipped IF blocks are listed too
+
+MACRO twice v
+	db v, v
+ENDM
+
+	org $8000
+	lda far		; 3 bytes on pass 1, 2 once far is known
+	jmp far
+	db "a long line of data bytes"
+	twice 3
+	REPT 2
+	nop
+	ENDR
+if 0
+	db $ff		; skipped
+endif
+	.dsb 3
+	dw far, near
+near:
+	rts
+far = $10
@@ -0,0 +1,30 @@
+; macro arguments are bound when the macro is expanded. a VALUE with the
+; same name only takes over if it was set before the expansion, not when
+; it's set further down the source (that used to win from pass 2 on)
+
+MACRO put n
+	db n
+ENDM
+
+MACRO fill cnt, v
+	REPT cnt
+	db v
+	ENDR
+ENDM
+
+MACRO pair a, b
+	db a, b, a+b
+ENDM
+
+	org $8000
+	jmp fwd
+	put 5
+	fill 3, $ee
+	pair 1, 2
+	pair "x", 'y'
+n = 1
+cnt = 1
+	put 6
+	fill 2, n
+	put n+8
+fwd:
@@ -0,0 +1,21 @@
+; lines are memoized on one pass and replayed on the next. a forward
+; reference (jmp fwd) leaves eval's "unresolved" flag set on pass 1, which
+; used to get 5+1 recorded as 5 and replayed that way on the later passes
+
+	org $8000
+sym = $8123
+reset:
+	jmp fwd
+	db 5+1
+	dw reset-1, nmi-1, fwd-1	; RTS table
+	dw sym-$8000
+	db <(sym+2), >(sym+$100)
+	jmp fwd
+	dw sym-$8000, reset+1
+	lda #2*3+1
+	lda sym+1,x
+nmi:
+	rti
+fwd:
+	hex 01 02
+	db fwd-reset, 1+2+3
@@ -0,0 +1,14 @@
+; --pass-report: pass 1 can't resolve the forward references, pass 2 moves
+; the labels after "lda zp" (zero page once zp is known), pass 3 settles
+
+	org $8000
+start:
+	lda zp
+	jmp later
+	dw table
+later:
+	rts
+table:
+	db 1, 2, 3
+	jmp start
+zp = $20
@@ -0,0 +1,9 @@
+; defs.inc is assembled on the first run and saved in _tmp/; the second run
+; defines everything from that snapshot instead. the output must not change
+
+	include defs.inc
+	org $c000
+	poke PPU_CTRL, $80
+	poke PPU_MASK, $1e
+	lda OAM+4,x
+	db <PPU_MASK
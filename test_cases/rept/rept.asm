@@ -0,0 +1,36 @@
+; REPT bodies are lexed once per expansion and replayed for each loop.
+; nested REPTs, labels local to each loop, REPT 0 and REPT inside IF
+
+	org $8000
+i = 0
+	REPT 3
+	db i
+	REPT 2
+	db $f0+i
+	ENDR
+i = i+1
+	ENDR
+
+	REPT 4
+@here:
+	dw @here
+	ENDR
+
+	REPT 0
+	db $ff
+	ENDR
+
+if 1
+	REPT 2
+	nop ; the comment goes to the listing
+	ENDR
+else
+	REPT 2
+	db $ff
+	ENDR
+endif
+
+count = 3
+	REPT count*2
+-	bne -
+	ENDR
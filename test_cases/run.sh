@@ -0,0 +1,73 @@
+#!/bin/sh
+# run.sh <asm6f> : assemble every test_cases/<name>/<name>.asm and compare what
+# it writes against the expected.* files next to it.
+#
+#   expected.<ext>  compared with _out.<ext> (or <name>.<ext> for files that
+#                   asm6f names after the source, like .cdl)
+#   expected.err    compared with whatever asm6f printed to stderr
+#   expected.out    compared with what it printed to stdout, with timings
+#                   ("0.012 s") replaced by "T s"
+#   args            extra command line options
+#   cmd             replaces the whole command line (for --batch and friends)
+#   xfail           a known bug: the test is still run and reported, but a
+#                   mismatch doesn't fail the suite
+#
+# each test is assembled twice so anything kept between runs (--cache, --pch)
+# gets exercised too.  _tmp/ is created for tests that want a scratch dir.
+
+asm6f=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+cd "$(dirname "$0")" || exit 1
+failed=0
+xfailed=0
+total=0
+
+for dir in */; do
+	name=${dir%/}
+	[ -f "$name/$name.asm" ] || continue
+	total=$((total+1))
+	(
+		cd "$name" || exit 1
+		rm -rf _tmp _out.* _err.txt; mkdir _tmp
+		if [ -f cmd ]; then
+			set -- $(cat cmd)
+		else
+			set -- -q
+			[ -f args ] && set -- "$@" $(cat args)
+			set -- "$@" "$name.asm" _out.bin
+			[ -f expected.lst ] && set -- "$@" _out.lst
+		fi
+		status=0
+		for run in 1 2; do
+			"$asm6f" "$@" 2>_err.txt | sed 's/[0-9]*\.[0-9]* s\b/T s/g' >_out.txt
+			for exp in expected.*; do
+				ext=${exp#expected.}
+				if [ "$ext" = err ]; then
+					out=_err.txt
+				elif [ "$ext" = out ]; then
+					out=_out.txt
+				elif [ -f "_out.$ext" ]; then
+					out=_out.$ext
+				else
+					out=$name.$ext
+				fi
+				if ! cmp -s "$exp" "$out"; then
+					echo "FAIL: $name (run $run, $out)"
+					status=1
+				fi
+			done
+			[ $status = 0 ] || break
+			rm -f _out.* "$name.cdl"
+		done
+		rm -rf _tmp _out.* _err.txt "$name.cdl"
+		exit $status
+	) && continue
+	if [ -f "$name/xfail" ]; then
+		echo "  (known failure: $(head -n 1 "$name/xfail"))"
+		xfailed=$((xfailed+1))
+	else
+		failed=$((failed+1))
+	fi
+done
+
+echo "$((total-failed-xfailed)) of $total tests passed, $xfailed known failures"
+[ $failed = 0 ]